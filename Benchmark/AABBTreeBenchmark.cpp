@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2019-2024 OtSofware
+ * This code is licensed under the GNU Lesser General Public License v3.0 (LGPL-3.0).
+ * For more information, including options for a more permissive commercial license,
+ * please visit [otyazilim.com] or contact us at [info@otyazilim.com].
+ */
+
+#include "AABBTree.h"
+#include "Benchmark.h"
+
+namespace ToolKit
+{
+  namespace Benchmark
+  {
+
+    void RunAABBTreeBenchmark()
+    {
+      ReportHeading("AABBTree, binned SAH rebuild against the incrementally built tree");
+
+      const int queryIterations = 20;
+      EntityPtrArray entities   = CreateEntityPool(1024);
+
+      for (int count : {10000, 100000})
+      {
+        float extent    = glm::pow((float) count, 1.0f / 3.0f) * 10.0f;
+        Frustum frustum = ViewFrustum(extent);
+
+        BoundingBoxArray boxes;
+        boxes.reserve(count);
+        for (int i = 0; i < count; i++)
+        {
+          boxes.push_back(ScatteredBox(i, extent));
+        }
+
+        // Leaves are inserted one by one, the way scenes have built their trees before the rebuild.
+        AABBTree incrementalTree;
+        float insertTime = Measure(
+            [&]()
+            {
+              for (int i = 0; i < count; i++)
+              {
+                incrementalTree.CreateNode(entities[i % entities.size()], boxes[i]);
+              }
+              incrementalTree.UpdateTree();
+            });
+        Report("Incremental build", count, insertTime);
+
+        AABBTree rebuiltTree;
+        for (int i = 0; i < count; i++)
+        {
+          rebuiltTree.CreateNode(entities[i % entities.size()], boxes[i]);
+        }
+
+        float rebuildTime = Measure([&]() { rebuiltTree.Rebuild(); });
+        Report("Rebuild", count, rebuildTime);
+
+        // First queries build the wide trees, they are left out of the measurements.
+        size_t incrementalHits = incrementalTree.VolumeQuery(frustum).size();
+        size_t rebuiltHits     = rebuiltTree.VolumeQuery(frustum).size();
+
+        float incrementalQueryTime =
+            MeasureAverage(queryIterations, [&]() { incrementalTree.VolumeQuery(frustum); });
+        Report("Frustum query, incremental tree", (int) incrementalHits, incrementalQueryTime);
+
+        float rebuiltQueryTime = MeasureAverage(queryIterations, [&]() { rebuiltTree.VolumeQuery(frustum); });
+        Report("Frustum query, rebuilt tree", (int) rebuiltHits, rebuiltQueryTime);
+      }
+    }
+
+  } // namespace Benchmark
+} // namespace ToolKit
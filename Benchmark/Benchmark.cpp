@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2019-2024 OtSofware
+ * This code is licensed under the GNU Lesser General Public License v3.0 (LGPL-3.0).
+ * For more information, including options for a more permissive commercial license,
+ * please visit [otyazilim.com] or contact us at [info@otyazilim.com].
+ */
+
+#include "Benchmark.h"
+
+#include "Entity.h"
+#include "MathUtil.h"
+#include "Threads.h"
+
+#include <stdio.h>
+#include <string.h>
+
+namespace ToolKit
+{
+  namespace Benchmark
+  {
+
+    void Report(const char* name, int itemCount, float milliseconds)
+    {
+      double nsPerItem = itemCount > 0 ? milliseconds * 1000000.0 / itemCount : 0.0;
+      printf("  %-36s %9d items %12.3f ms %12.1f ns/item\n", name, itemCount, milliseconds, nsPerItem);
+    }
+
+    void ReportHeading(const char* name) { printf("\n%s\n", name); }
+
+    Vec3 ScatteredPosition(int index, float extent)
+    {
+      // Hashing the index keeps the positions reproducible between runs and benchmarks.
+      uint64 hash = MurmurHash((uint64) index + 1);
+      Vec3 unit   = Vec3((float) (hash & 0xFFFFF), (float) ((hash >> 20) & 0xFFFFF), (float) ((hash >> 40) & 0xFFFFF));
+      return (unit / (float) 0xFFFFF - 0.5f) * extent;
+    }
+
+    BoundingBox ScatteredBox(int index, float extent)
+    {
+      Vec3 center   = ScatteredPosition(index, extent);
+      Vec3 halfSize = Vec3(0.5f + (float) (MurmurHash((uint64) index) % 3) * 0.5f);
+      return BoundingBox(center - halfSize, center + halfSize);
+    }
+
+    Frustum ViewFrustum(float extent)
+    {
+      Mat4 project = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, extent * 2.0f);
+      Mat4 view    = glm::lookAt(Vec3(extent * 0.5f), Vec3(0.0f), Y_AXIS);
+      return ExtractFrustum(project * view, false);
+    }
+
+    EntityPtrArray CreateEntityPool(int count)
+    {
+      EntityPtrArray entities;
+      for (int i = 0; i < count; i++)
+      {
+        entities.push_back(MakeNewPtr<Entity>());
+      }
+      return entities;
+    }
+
+    struct BenchmarkEntry
+    {
+      const char* name;
+      void (*run)();
+    };
+
+    static const BenchmarkEntry Benchmarks[] = {
+        {"Scene",    RunSceneBenchmark   },
+        {"AABBTree", RunAABBTreeBenchmark},
+        {"WideTree", RunWideTreeBenchmark},
+        {"SkinMesh", RunSkinMeshBenchmark},
+    };
+
+  } // namespace Benchmark
+} // namespace ToolKit
+
+int main(int argc, char* argv[])
+{
+  using namespace ToolKit;
+
+  // Only the cpu side systems are initialized, there is no render context.
+  Main* main = new Main();
+  Main::SetProxy(main);
+  main->PreInit();
+  GetWorkerManager()->Init();
+
+  printf("Worker threads: %d\n", GetWorkerManager()->GetThreadCount(WorkerManager::FramePool));
+
+#ifndef NDEBUG
+  // Timings of builds with assertions are not comparable, only release builds are reported.
+  printf("Warning: Assertions are enabled, configure with -DCMAKE_BUILD_TYPE=Release for comparable timings.\n");
+#endif
+
+  // Benchmarks given in the arguments are run, all of them if there are none.
+  for (const Benchmark::BenchmarkEntry& benchmark : Benchmark::Benchmarks)
+  {
+    bool selected = argc < 2;
+    for (int i = 1; i < argc; i++)
+    {
+      selected |= strcmp(argv[i], benchmark.name) == 0;
+    }
+
+    if (selected)
+    {
+      benchmark.run();
+    }
+  }
+
+  GetWorkerManager()->UnInit();
+  main->PostUninit();
+  SafeDel(main);
+
+  return 0;
+}
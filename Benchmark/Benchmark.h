@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2019-2024 OtSofware
+ * This code is licensed under the GNU Lesser General Public License v3.0 (LGPL-3.0).
+ * For more information, including options for a more permissive commercial license,
+ * please visit [otyazilim.com] or contact us at [info@otyazilim.com].
+ */
+
+#pragma once
+
+#include "ToolKit.h"
+#include "Util.h"
+
+namespace ToolKit
+{
+  namespace Benchmark
+  {
+    /** Returns the duration of the given function in milliseconds. */
+    template <typename Fn>
+    float Measure(Fn&& fn)
+    {
+      float begin = GetElapsedMilliSeconds();
+      fn();
+      return GetElapsedMilliSeconds() - begin;
+    }
+
+    /** Returns the average duration of the given function over the iterations in milliseconds. */
+    template <typename Fn>
+    float MeasureAverage(int iterations, Fn&& fn)
+    {
+      float begin = GetElapsedMilliSeconds();
+      for (int i = 0; i < iterations; i++)
+      {
+        fn();
+      }
+      return (GetElapsedMilliSeconds() - begin) / iterations;
+    }
+
+    /**
+     * Prints a result row. Time per item is printed along with the total time, it stays flat as the item count grows
+     * for the operations that scale linearly.
+     * @param name is the name of the measured operation.
+     * @param itemCount is the number of items that the operation processed.
+     * @param milliseconds is the duration of the operation.
+     */
+    void Report(const char* name, int itemCount, float milliseconds);
+
+    /** Prints the heading of a benchmark. */
+    void ReportHeading(const char* name);
+
+    /** Returns a position in a cube of the given size. Positions are deterministic for the same index. */
+    Vec3 ScatteredPosition(int index, float extent);
+
+    /** Returns a box of 1 to 3 units wide around the scattered position of the index. */
+    BoundingBox ScatteredBox(int index, float extent);
+
+    /** Returns the frustum of a camera that looks at the center of the cube of the given size from its corner. */
+    Frustum ViewFrustum(float extent);
+
+    /**
+     * Creates entities for the aabb tree leaves. Leaves share a small pool of entities cyclically instead of creating
+     * an entity each, so millions of leaves fit in the memory.
+     */
+    EntityPtrArray CreateEntityPool(int count);
+
+    // Benchmarks, each is run by Benchmark.cpp.
+
+    /** Scene entity add, lookup, load and removal at growing entity counts. */
+    void RunSceneBenchmark();
+
+    /** AABBTree rebuild against the incrementally built tree, build times and frustum query costs. */
+    void RunAABBTreeBenchmark();
+
+    /** Frustum and box queries on the four wide tree against testing each box, up to a million leaves. */
+    void RunWideTreeBenchmark();
+
+    /** SkinMesh bind pose bounding box calculation against the locked per vertex reduction it replaced. */
+    void RunSkinMeshBenchmark();
+
+  } // namespace Benchmark
+} // namespace ToolKit
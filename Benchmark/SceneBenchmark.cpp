@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2019-2024 OtSofware
+ * This code is licensed under the GNU Lesser General Public License v3.0 (LGPL-3.0).
+ * For more information, including options for a more permissive commercial license,
+ * please visit [otyazilim.com] or contact us at [info@otyazilim.com].
+ */
+
+#include "AABBOverrideComponent.h"
+#include "Benchmark.h"
+#include "Entity.h"
+#include "Node.h"
+#include "Scene.h"
+
+#include <random>
+
+namespace ToolKit
+{
+  namespace Benchmark
+  {
+
+    void RunSceneBenchmark()
+    {
+      ReportHeading("Scene, add, lookup, load and removal of entities");
+
+      for (int count : {1000, 10000, 60000})
+      {
+        // Entities form a hierarchy that load resolves by ids, each is parented to one that comes before it.
+        EntityPtrArray entities;
+        entities.reserve(count);
+        for (int i = 0; i < count; i++)
+        {
+          EntityPtr ntt = MakeNewPtr<Entity>();
+          ntt->AddComponent<AABBOverrideComponent>();
+          ntt->m_node->SetTranslation(ScatteredPosition(i, 1000.0f));
+          if (i > 0)
+          {
+            entities[i / 2]->m_node->AddChild(ntt->m_node, true);
+          }
+          entities.push_back(ntt);
+        }
+
+        ScenePtr scene = MakeNewPtr<Scene>();
+        float addTime  = Measure(
+            [&]()
+            {
+              for (EntityPtr& ntt : entities)
+              {
+                scene->AddEntity(ntt);
+              }
+            });
+        Report("AddEntity", count, addTime);
+
+        int found        = 0;
+        float lookupTime = Measure(
+            [&]()
+            {
+              for (EntityPtr& ntt : entities)
+              {
+                found += scene->GetEntity(ntt->GetIdVal()) != nullptr;
+              }
+            });
+        Report("GetEntity", found, lookupTime);
+
+        // Load the serialized scene back, covers entity creation, parent resolution and the tree rebuild.
+        XmlDocument doc;
+        scene->Serialize(&doc, nullptr);
+
+        ScenePtr loaded = MakeNewPtr<Scene>();
+        float loadTime  = Measure(
+            [&]()
+            {
+              SerializationFileInfo info;
+              info.Document = &doc;
+              info.Version  = TKVersionStr;
+              loaded->DeSerialize(info, doc.first_node(XmlSceneElement.c_str()));
+            });
+        Report("DeSerialize", (int) loaded->GetEntities().size(), loadTime);
+
+        // Removal order is shuffled, removing from the back of the list would hide the cost of lookups and moves.
+        std::vector<ULongID> ids;
+        ids.reserve(count);
+        for (EntityPtr& ntt : entities)
+        {
+          ids.push_back(ntt->GetIdVal());
+        }
+        std::shuffle(ids.begin(), ids.end(), std::mt19937(count));
+
+        float removeTime = Measure(
+            [&]()
+            {
+              for (ULongID id : ids)
+              {
+                scene->RemoveEntity(id, false);
+              }
+            });
+        Report("RemoveEntity", count, removeTime);
+
+        doc.clear();
+      }
+    }
+
+  } // namespace Benchmark
+} // namespace ToolKit
@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2019-2024 OtSofware
+ * This code is licensed under the GNU Lesser General Public License v3.0 (LGPL-3.0).
+ * For more information, including options for a more permissive commercial license,
+ * please visit [otyazilim.com] or contact us at [info@otyazilim.com].
+ */
+
+#include "Benchmark.h"
+#include "MathUtil.h"
+#include "Mesh.h"
+#include "Skeleton.h"
+#include "Threads.h"
+
+namespace ToolKit
+{
+  namespace Benchmark
+  {
+
+    void RunSkinMeshBenchmark()
+    {
+      ReportHeading("SkinMesh, bind pose bounding box reduction");
+
+      const int iterations = 10;
+      const int boneCount  = 64;
+
+      SkeletonPtr skeleton = MakeNewPtr<Skeleton>();
+      for (int i = 0; i < boneCount; i++)
+      {
+        StaticBone* bone           = new StaticBone("Bone" + std::to_string(i));
+        bone->m_inverseWorldMatrix = glm::translate(Mat4(1.0f), -ScatteredPosition(i, 2.0f));
+        skeleton->m_bones.push_back(bone);
+      }
+      skeleton->m_initiated = true;
+
+      Mat4Array palette;
+      CalculateSkinningPalette(skeleton.get(), nullptr, false, palette);
+
+      for (int count : {10000, 100000, 1000000})
+      {
+        std::vector<SkinVertex> vertices(count);
+        for (int i = 0; i < count; i++)
+        {
+          SkinVertex& vertex = vertices[i];
+          uint64 hash        = MurmurHash((uint64) i);
+          vertex.pos         = ScatteredPosition(i, 2.0f);
+          vertex.bones       = Vec4((float) (hash % boneCount), (float) ((hash >> 8) % boneCount), 0.0f, 0.0f);
+          vertex.weights     = Vec4(0.75f, 0.25f, 0.0f, 0.0f);
+        }
+
+        // The reduction before the chunked one, workers update a shared box under a lock for every vertex.
+        BoundingBox lockedAABB;
+        std::mutex lockedAABBMutex;
+        float lockedTime = MeasureAverage(iterations,
+                                          [&]()
+                                          {
+                                            std::for_each(TKExecBy(WorkerManager::FramePool),
+                                                          vertices.begin(),
+                                                          vertices.end(),
+                                                          [&](const SkinVertex& vertex)
+                                                          {
+                                                            Vec3 skinnedPos = CPUSkinning(&vertex, palette);
+                                                            std::lock_guard<std::mutex> lock(lockedAABBMutex);
+                                                            lockedAABB.UpdateBoundary(skinnedPos);
+                                                          });
+                                          });
+        Report("Locked reduction", count, lockedTime);
+
+        // The chunked reduction that SkinMesh::CalculateAABB runs for each mesh, called directly since creating a
+        // mesh needs the default material of an initialized renderer.
+        float chunkedTime = MeasureAverage(iterations,
+                                           [&]() { SkinnedBoundingBox(vertices.data(), vertices.size(), palette); });
+        Report("Chunked reduction", count, chunkedTime);
+      }
+    }
+
+  } // namespace Benchmark
+} // namespace ToolKit
@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2019-2024 OtSofware
+ * This code is licensed under the GNU Lesser General Public License v3.0 (LGPL-3.0).
+ * For more information, including options for a more permissive commercial license,
+ * please visit [otyazilim.com] or contact us at [info@otyazilim.com].
+ */
+
+#include "AABBTree.h"
+#include "Benchmark.h"
+#include "MathUtil.h"
+
+namespace ToolKit
+{
+  namespace Benchmark
+  {
+
+    void RunWideTreeBenchmark()
+    {
+      ReportHeading("AABBTree, four wide tree volume queries");
+
+      const int queryIterations = 10;
+      EntityPtrArray entities   = CreateEntityPool(1024);
+
+      for (int count : {10000, 100000, 1000000})
+      {
+        float extent    = glm::pow((float) count, 1.0f / 3.0f) * 10.0f;
+        Frustum frustum = ViewFrustum(extent);
+        BoundingBox box = BoundingBox(Vec3(-extent * 0.125f), Vec3(extent * 0.125f));
+
+        BoundingBoxArray boxes;
+        boxes.reserve(count);
+        AABBTree tree;
+        for (int i = 0; i < count; i++)
+        {
+          boxes.push_back(ScatteredBox(i, extent));
+          tree.CreateNode(entities[i % entities.size()], boxes[i]);
+        }
+        tree.Rebuild();
+
+        // First query builds the wide tree, it is left out of the query measurements.
+        float wideBuildTime = Measure([&]() { tree.VolumeQuery(frustum); });
+        Report("Wide tree build and first query", count, wideBuildTime);
+
+        // Reference cost of testing every box one at a time, which the binary tree did at each visited node.
+        int scalarHits       = 0;
+        float scalarTestTime = MeasureAverage(queryIterations,
+                                              [&]()
+                                              {
+                                                scalarHits = 0;
+                                                for (const BoundingBox& leafBox : boxes)
+                                                {
+                                                  scalarHits += FrustumBoxIntersection(frustum, leafBox) !=
+                                                                IntersectResult::Outside;
+                                                }
+                                              });
+        Report("Frustum test, each box", scalarHits, scalarTestTime);
+
+        size_t frustumHits     = tree.VolumeQuery(frustum).size();
+        float frustumQueryTime = MeasureAverage(queryIterations, [&]() { tree.VolumeQuery(frustum); });
+        Report("Frustum query", (int) frustumHits, frustumQueryTime);
+
+        float threadedQueryTime = MeasureAverage(queryIterations, [&]() { tree.VolumeQuery(frustum, true); });
+        Report("Frustum query, threaded", (int) frustumHits, threadedQueryTime);
+
+        size_t boxHits     = tree.VolumeQuery(box).size();
+        float boxQueryTime = MeasureAverage(queryIterations, [&]() { tree.VolumeQuery(box); });
+        Report("Box query", (int) boxHits, boxQueryTime);
+      }
+    }
+
+  } // namespace Benchmark
+} // namespace ToolKit
@@ -565,12 +565,12 @@ namespace ToolKit
 
         for (RenderJob& job : jobs)
         {
-          if (RenderJobProcessor::IsOutlier(job, 3.0f, stdev, mean))
+          if (RenderJobProcessor::IsOutlier(jobs, job, 3.0f, stdev, mean))
           {
             fixProblemFn(job.Entity, "Entity: %s ID: %llu is an outlier.");
           }
 
-          if (!job.BoundingBox.IsValid())
+          if (!jobs.GetBoundingBox(job).IsValid())
           {
             fixProblemFn(job.Entity, "Entity: %s ID: %llu has invalid bounding box.");
           }
@@ -396,7 +396,7 @@ namespace ToolKit
 
         EntityRawPtrArray rawNtties = ToEntityRawPtrArray(highlightList);
         RenderJobProcessor::CreateRenderJobs(renderJobs, rawNtties, true);
-        renderJobs.insert(renderJobs.end(), billboardJobs.begin(), billboardJobs.end());
+        renderJobs.Append(billboardJobs);
 
         FrustumCull(renderJobs, viewportCamera, m_unCulledRenderJobs);
 
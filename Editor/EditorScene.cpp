@@ -18,7 +18,11 @@ namespace ToolKit
 
     TKDefineClass(EditorScene, Scene);
 
-    EditorScene::EditorScene() { m_newScene = false; }
+    EditorScene::EditorScene()
+    {
+      m_newScene        = false;
+      m_keepEntityOrder = true; // Outliner lists and reorders the entities in the scene order.
+    }
 
     EditorScene::~EditorScene() { Destroy(false); }
 
@@ -151,16 +155,11 @@ namespace ToolKit
         {
           int dirStart = RenderJobProcessor::PreSortLights(lights);
 
-          for (RenderJob& job : jobs)
-          {
-            RenderJobProcessor::AssignLight(job, lights, dirStart);
-          }
-
-          RenderJob& job = jobs.front();
+          LightRawPtrArray affectingLights;
+          RenderJobProcessor::CollectLights(jobs.GetBoundingBox(jobs.front()), lights, dirStart, affectingLights);
 
-          for (size_t i = 0; i < job.lights.size(); i++)
+          for (Light* light : affectingLights)
           {
-            Light* light = job.lights[i];
             if (!IsSelected(light->GetIdVal()))
             {
               AddToSelection(light->GetIdVal(), true);
@@ -691,7 +691,7 @@ namespace ToolKit
                   uint submeshIndx = FindMeshIntersection(pd.entity, ray, t);
                   if (submeshIndx != TK_UINT_MAX && t != TK_FLT_MAX)
                   {
-                    mmPtr->GetMaterialList()[submeshIndx] = material;
+                    mmPtr->SetMaterial(submeshIndx, material);
                   }
                 }
                 else
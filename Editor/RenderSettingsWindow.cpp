@@ -151,6 +151,14 @@ namespace ToolKit
           g_app->ReInitViewports();
         }
 
+        ImGui::Checkbox("Bone Palette Skinning##1", &engineSettings.Graphics.useBonePaletteSkinning);
+        UI::AddTooltipToLastItem("Poses skeletons on the cpu and uploads their bone matrices each frame.\nFrees the "
+                                 "baked animation textures.");
+
+        ImGui::Checkbox("Half Precision Animations##1", &engineSettings.Graphics.useHalfPrecisionAnimations);
+        UI::AddTooltipToLastItem("Bakes animation textures in half precision for the skinned meshes that stay close "
+                                 "to their origin.\nLarger meshes are baked in 32 bit.");
+
         float renderScale = engineSettings.Graphics.renderResolutionScale;
         if (ImGui::DragFloat("Resolution Multiplier", &renderScale, 0.05f, 0.25f, 1.0f))
         {
@@ -327,6 +335,21 @@ namespace ToolKit
         UI::AddTooltipToLastItem("Prevents shimmering / swimming effects by wasting some shadow map resolution to "
                                  "prevent sub-pixel movements.");
 
+        ImGui::DragInt("Shadow Update Budget", &engineSettings.Graphics.shadowMapUpdateBudget, 1, 0, 256);
+        UI::AddTooltipToLastItem("Maximum number of shadow maps rendered in a frame, a cube face or a cascade is one "
+                                 "map.\nPostponed maps keep their last content. 0 disables the limit.");
+
+        ImGui::DragInt("Cascade Update Interval", &engineSettings.Graphics.shadowCascadeUpdateInterval, 1, 1, 16);
+        UI::AddTooltipToLastItem("Cascades after the first one are refreshed once in this many frames.");
+
+        ImGui::Checkbox("Adaptive Shadow Resolution", &engineSettings.Graphics.adaptiveShadowResolution);
+        UI::AddTooltipToLastItem("Lowers the shadow resolution of point and spot lights that cover a small portion of "
+                                 "the screen.\nLight's shadow resolution is the upper limit.");
+
+        ImGui::DragInt("Shadow Atlas Budget (MB)", &engineSettings.Graphics.shadowAtlasBudgetMB, 1, 0, 4096);
+        UI::AddTooltipToLastItem("Memory budget of the shadow atlas. Lights with the least screen coverage are "
+                                 "downscaled to fit.\n0 disables the limit.");
+
         static bool highLightCascades = false;
         if (ImGui::Checkbox("Highlight Cascades", &highLightCascades))
         {
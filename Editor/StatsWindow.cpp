@@ -58,6 +58,10 @@ namespace ToolKit
         ImGui::Text("Total Hardware Render Pass: %llu", g_app->GetLastFrameHWRenderPassCount());
         ImGui::Text("Approximate Total VRAM Usage: %llu MB", Stats::GetTotalVRAMUsageInMB());
         ImGui::Text("Light Cache Invalidation Per Frame: %u", Stats::GetLightCacheInvalidationPerFrame());
+        ImGui::Text("Shadow Map Updates Per Frame: %llu", Stats::GetShadowMapUpdatesPerFrame());
+        ImGui::Text("Shadow Map Skips Per Frame: %llu", Stats::GetShadowMapSkipsPerFrame());
+        ImGui::Text("Frame Arena Usage: %llu KB", Stats::GetFrameArenaBytes() / 1024);
+        ImGui::Text("Frame Arena Saved Allocations: %llu", Stats::GetFrameArenaSavedAllocations());
       }
       ImGui::End();
     }
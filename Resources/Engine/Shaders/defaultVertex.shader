@@ -1,11 +1,13 @@
 <shader>
 	<type name = "vertexShader" />
     <include name = "skinning.shader" />
+    <include name = "instancing.shader" />
     <uniform name = "ProjectViewModel" />
     <uniform name = "InverseTransModel" />
     <uniform name = "Model" />
     <uniform name = "normalMapInUse" />
     <uniform name = "modelViewMatrix" />
+    <uniform name = "View" />
 	<source>
 	<!--
 #version 300 es
@@ -21,6 +23,7 @@ uniform mat4 ProjectViewModel;
 uniform mat4 InverseTransModel;
 uniform mat4 Model;
 uniform mat4 modelViewMatrix;
+uniform mat4 View;
 
 uniform int normalMapInUse;
 
@@ -32,13 +35,25 @@ out mat3 TBN;
 
 void main()
 {
+  mat4 model            = Model;
+  mat4 invTrModel       = InverseTransModel;
+  mat4 projectViewModel = ProjectViewModel;
+  mat4 modelView        = modelViewMatrix;
+  if (isInstanced > 0u)
+  {
+    model            = vInstanceModel;
+    invTrModel       = mat4(vInstanceNormal);
+    projectViewModel = ProjectView * model;
+    modelView        = View * model;
+  }
+
   gl_Position = vec4(vPosition, 1.0f);
   if(isSkinned > 0u)
   {
     if (normalMapInUse == 1)
     {
-      vec3 B = normalize(vec3(Model * vec4(vBiTan, 0.0)));
-      vec3 N = normalize(vec3(Model * vec4(vNormal, 0.0)));
+      vec3 B = normalize(vec3(model * vec4(vBiTan, 0.0)));
+      vec3 N = normalize(vec3(model * vec4(vNormal, 0.0)));
 
       skin(gl_Position, N, B, gl_Position, N, B);
 
@@ -47,7 +62,7 @@ void main()
     }
     else
     {
-      v_normal = (InverseTransModel * vec4(vNormal, 1.0)).xyz;
+      v_normal = (invTrModel * vec4(vNormal, 1.0)).xyz;
       skin(gl_Position, v_normal, gl_Position, v_normal);
     }
   }
@@ -55,20 +70,20 @@ void main()
   {
     if (normalMapInUse == 1)
     {
-      vec3 B = normalize(vec3(Model * vec4(vBiTan, 0.0)));
-      vec3 N = normalize(vec3(Model * vec4(vNormal, 0.0)));
+      vec3 B = normalize(vec3(model * vec4(vBiTan, 0.0)));
+      vec3 N = normalize(vec3(model * vec4(vNormal, 0.0)));
       vec3 T = normalize(cross(B,N));
       TBN = mat3(T,B,N);
     }
     else
     {
-      v_normal = (InverseTransModel * vec4(vNormal, 1.0)).xyz;
+      v_normal = (invTrModel * vec4(vNormal, 1.0)).xyz;
     }
   }
 
-  v_pos = (Model * gl_Position).xyz;
-  v_viewPosDepth = (modelViewMatrix * gl_Position).z;
-  gl_Position = ProjectViewModel * gl_Position;
+  v_pos = (model * gl_Position).xyz;
+  v_viewPosDepth = (modelView * gl_Position).z;
+  gl_Position = projectViewModel * gl_Position;
   v_texture = vTexture;
 }
 	-->
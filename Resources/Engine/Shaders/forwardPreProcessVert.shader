@@ -1,6 +1,7 @@
 <shader>
   <type name = "vertexShader" />
   <include name = "skinning.shader" />
+  <include name = "instancing.shader" />
   <uniform name = "ProjectViewModel" />
   <uniform name = "Model" />
   <uniform name = "View" />
@@ -30,14 +31,24 @@
       
       void main()
       {
+        mat4 model            = Model;
+        mat4 invTrModel       = InverseTransModel;
+        mat4 projectViewModel = ProjectViewModel;
+        if (isInstanced > 0u)
+        {
+          model            = vInstanceModel;
+          invTrModel       = mat4(vInstanceNormal);
+          projectViewModel = ProjectView * model;
+        }
+
         gl_Position   = vec4(vPosition, 1.0f);
 
          if(isSkinned > 0u)
          {
             if (normalMapInUse == 1)
             {
-               vec3 B = normalize(vec3(Model * vec4(vBiTan, 0.0)));
-               vec3 N = normalize(vec3(Model * vec4(vNormal, 0.0)));
+               vec3 B = normalize(vec3(model * vec4(vBiTan, 0.0)));
+               vec3 N = normalize(vec3(model * vec4(vNormal, 0.0)));
 
                skin(gl_Position, N, B, gl_Position, N, B);
 
@@ -46,7 +57,7 @@
             }
             else
             {
-               v_normal = (InverseTransModel * vec4(vNormal, 1.0)).xyz;
+               v_normal = (invTrModel * vec4(vNormal, 1.0)).xyz;
                skin(gl_Position, v_normal, gl_Position, v_normal);
             }
          }
@@ -54,23 +65,23 @@
          {
 			if (normalMapInUse == 1)
 			{
-               vec3 B = normalize(vec3(Model * vec4(vBiTan, 0.0)));
-               vec3 N = normalize(vec3(Model * vec4(vNormal, 0.0)));
+               vec3 B = normalize(vec3(model * vec4(vBiTan, 0.0)));
+               vec3 N = normalize(vec3(model * vec4(vNormal, 0.0)));
                vec3 T = normalize(cross(B,N));
                TBN = mat3(T,B,N);
             }
             else
             {
-               v_normal = (InverseTransModel * vec4(vNormal, 1.0)).xyz;
+               v_normal = (invTrModel * vec4(vNormal, 1.0)).xyz;
             }
          }
 
-        vec3 v_pos    = (Model * gl_Position).xyz;
+        vec3 v_pos    = (model * gl_Position).xyz;
         v_viewDepth = (View * vec4(v_pos, 1.0)).xyz;
         
         v_texture = vTexture;
 
-        gl_Position   = ProjectViewModel * gl_Position;
+        gl_Position   = projectViewModel * gl_Position;
       }
 	-->
 	</source>
@@ -0,0 +1,24 @@
+<shader>
+	<type name = "includeShader" />
+  <uniform name = "isInstanced" />
+  <uniform name = "ProjectView" />
+	<source>
+	<!--
+
+#ifndef INSTANCING_SHADER
+#define INSTANCING_SHADER
+
+// Per instance world transform. Occupies locations 6 to 9, after the skinning attributes.
+layout(location = 6) in mat4 vInstanceModel;
+
+// Per instance inverse transpose of the world transform. Occupies locations 10 to 12.
+layout(location = 10) in mat3 vInstanceNormal;
+
+uniform uint isInstanced;
+uniform mat4 ProjectView;
+
+#endif
+
+	-->
+	</source>
+</shader>
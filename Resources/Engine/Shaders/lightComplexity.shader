@@ -1,6 +1,7 @@
 <shader>
 	<type name = "fragmentShader" />
 	<include name = "lighting.shader" />
+	<include name = "camera.shader" />
 	<uniform name = "UseIbl" />
 	<uniform name = "IblIntensity" />
 	<uniform name = "IBLIrradianceMap" />
@@ -51,7 +52,11 @@
 
 		void main()
 		{
-			vec3 color = GetHeatMap(float(activeCount), float(8));
+			// Lights of the fragment's cluster and the directional lights.
+			uvec2 cluster = LightGridCluster(dot(v_pos - CamData.pos, CamData.dir));
+			int lightCount = lightGridSize.w + int(cluster.y);
+
+			vec3 color = GetHeatMap(float(lightCount), float(8));
 			fragColor = vec4(color, 1.0);
 		}
 	-->
@@ -4,7 +4,10 @@
 	<include name = "shadow.shader" />
 	<include name = "pbr.shader" />
 	<uniform name = "shadowDistance" />
-	<uniform name = "activeCount" />
+	<uniform name = "lightGridSize" />
+	<uniform name = "lightGridSlicing" />
+	<uniform name = "lightGridTileSize" />
+	<uniform name = "cascadeDistances" />
 	<define name = "highlightCascades" val = "0,1" />
 	<source>
 	<!--
@@ -13,7 +16,11 @@
 #define LIGHTING_SHADER
 
 
-#define MAX_LIGHT_COUNT 40
+// Width of the light index texture. Matches LightGrid::LightIndexRowSize.
+#define LIGHT_INDEX_ROW_SIZE 1024u
+
+// Light data texture stores a row of texels for each light. Layout matches PerLightData.
+#define LIGHT_MATRIX_TEXEL 4
 
 // TODO Minimize and pack this data as much as possible
 struct _LightData
@@ -32,8 +39,8 @@ struct _LightData
 	float shadowMapCameraFar;
 	int numOfCascades;
 
-	mat4 projectionViewMatrices[MAX_CASCADE_COUNT];
-	
+	// Projection view matrices are fetched on demand with FetchLightMatrix.
+
 	float BleedingReduction;
 	float shadowBias;
 	int castShadow;
@@ -47,25 +54,87 @@ struct _LightData
 	vec2 shadowAtlasCoord; // Between 0 and 1
 };
 
-layout (std140) uniform LightDataBuffer // slot 0
+uniform float shadowDistance;
+uniform vec4 cascadeDistances; // Max cascade is 4, so this fits.
+uniform sampler2DArray s_texture8; // Shadow atlas
+
+uniform highp usampler2D s_texture10; // Light grid clusters. Light index offset and count of each cluster.
+uniform highp usampler2D s_texture11; // Light grid light indices.
+uniform highp sampler2D s_texture13; // Light data
+
+uniform ivec4 lightGridSize; // Tile count x, tile count y, slice count and directional light count.
+uniform vec3 lightGridSlicing; // Slice of a view depth is log(depth + z) * x + y.
+uniform vec2 lightGridTileSize; // Tile size in pixels.
+
+const float shadowFadeOutDistanceNorm = 0.9;
+
+_LightData FetchLightData(int index)
 {
-	vec4 cascadeDistances; // Max cascade is 4, so this fits.
-	_LightData LightData[MAX_LIGHT_COUNT];
-};
+	vec4 texel0 = texelFetch(s_texture13, ivec2(0, index), 0);
+	vec4 texel1 = texelFetch(s_texture13, ivec2(1, index), 0);
+	vec4 texel2 = texelFetch(s_texture13, ivec2(2, index), 0);
+	vec4 texel3 = texelFetch(s_texture13, ivec2(3, index), 0);
+
+	int shadowTexel = LIGHT_MATRIX_TEXEL + MAX_CASCADE_COUNT * 4;
+	vec4 texel4 = texelFetch(s_texture13, ivec2(shadowTexel, index), 0);
+	vec4 texel5 = texelFetch(s_texture13, ivec2(shadowTexel + 1, index), 0);
+	vec4 texel6 = texelFetch(s_texture13, ivec2(shadowTexel + 2, index), 0);
+
+	_LightData light;
+	light.pos = texel0.xyz;
+	light.type = int(texel0.w);
+	light.dir = texel1.xyz;
+	light.intensity = texel1.w;
+	light.color = texel2.xyz;
+	light.radius = texel2.w;
+	light.outAngle = texel3.x;
+	light.innAngle = texel3.y;
+	light.shadowMapCameraFar = texel3.z;
+	light.numOfCascades = int(texel3.w);
+	light.BleedingReduction = texel4.x;
+	light.shadowBias = texel4.y;
+	light.castShadow = int(texel4.z);
+	light.shadowAtlasLayer = int(texel4.w);
+	light.PCFSamples = int(texel5.x);
+	light.PCFRadius = texel5.y;
+	light.shadowAtlasResRatio = texel5.z;
+	light.shadowAtlasCoord = texel6.xy;
+	return light;
+}
 
-layout (std140) uniform ActiveLightIndicesBuffer // slot 1
+// Returns the projection view matrix of the light for the given cascade.
+mat4 FetchLightMatrix(int index, int cascade)
 {
-	ivec4 activeLightIndices[MAX_LIGHT_COUNT / 4]; // Each component of a vector is a light index.
-};
+	int column = LIGHT_MATRIX_TEXEL + cascade * 4;
+	return mat4
+	(
+		texelFetch(s_texture13, ivec2(column, index), 0),
+		texelFetch(s_texture13, ivec2(column + 1, index), 0),
+		texelFetch(s_texture13, ivec2(column + 2, index), 0),
+		texelFetch(s_texture13, ivec2(column + 3, index), 0)
+	);
+}
 
-uniform float shadowDistance;
-uniform int activeCount;
-uniform sampler2DArray s_texture8; // Shadow atlas
+// Returns the light index offset and the light count of the cluster that the fragment falls into.
+uvec2 LightGridCluster(float viewDepth)
+{
+	if (lightGridSize.z == 0)
+	{
+		return uvec2(0u);
+	}
 
-/// Deferred rendering uniforms
-uniform sampler2D s_texture13; // Light data
+	ivec2 tile = clamp(ivec2(gl_FragCoord.xy / lightGridTileSize), ivec2(0), lightGridSize.xy - 1);
+	float depth = max(viewDepth + lightGridSlicing.z, 1e-6);
+	int slice = clamp(int(floor(log(depth) * lightGridSlicing.x + lightGridSlicing.y)), 0, lightGridSize.z - 1);
+	return texelFetch(s_texture10, ivec2(tile.x + tile.y * lightGridSize.x, slice), 0).xy;
+}
 
-const float shadowFadeOutDistanceNorm = 0.9;
+// Returns the light index at the given position of the light index texture.
+int LightGridLightIndex(uint position)
+{
+	ivec2 coord = ivec2(int(position % LIGHT_INDEX_ROW_SIZE), int(position / LIGHT_INDEX_ROW_SIZE));
+	return int(texelFetch(s_texture11, coord, 0).x);
+}
 
 bool EpsilonEqual(float a, float b, float eps)
 {
@@ -241,50 +310,54 @@ vec3 PBRLighting
 {
 	vec3 irradiance = vec3(0.0);
 
-	for (int ii = 0; ii < activeCount; ii++)
+	// Directional lights affect all fragments, the rest comes from the fragment's cluster.
+	uvec2 cluster = LightGridCluster(abs(viewPosDepth));
+	int directionalCount = lightGridSize.w;
+	int lightCount = directionalCount + int(cluster.y);
+
+	for (int ii = 0; ii < lightCount; ii++)
 	{
-		int div = ii / 4;
-		int rem = ii % 4;
-		int i = activeLightIndices[div][rem];
+		int i = ii < directionalCount ? ii : LightGridLightIndex(cluster.x + uint(ii - directionalCount));
+		_LightData light = FetchLightData(i);
 
 		// TODO we can create uniform buffer for each light type and iterate those lights in order to avoid this if-else block.
-		if (LightData[i].type == 2) // Point light
+		if (light.type == 2) // Point light
 		{
 			// radius check and attenuation
-			float lightDistance = length(LightData[i].pos - fragPos);
-			float radiusCheck = RadiusCheck(LightData[i].radius, lightDistance);
-			float attenuation = Attenuation(lightDistance, LightData[i].radius, 1.0, 0.09, 0.032);
+			float lightDistance = length(light.pos - fragPos);
+			float radiusCheck = RadiusCheck(light.radius, lightDistance);
+			float attenuation = Attenuation(lightDistance, light.radius, 1.0, 0.09, 0.032);
 
 			// lighting
-			vec3 lightDir = normalize(LightData[i].pos - fragPos);
-			vec3 Lo = PBR(fragPos, normal, fragToEye, albedo, metallic, roughness, lightDir, LightData[i].color * LightData[i].intensity);
+			vec3 lightDir = normalize(light.pos - fragPos);
+			vec3 Lo = PBR(fragPos, normal, fragToEye, albedo, metallic, roughness, lightDir, light.color * light.intensity);
 
 			// shadow
 			float shadow = 1.0;
-			if (LightData[i].castShadow == 1)
+			if (light.castShadow == 1)
 			{
 				shadow = CalculatePointShadow
 				(
 					fragPos, 
-					LightData[i].pos, 
-					LightData[i].shadowMapCameraFar, 
-					LightData[i].shadowAtlasCoord, 
-					LightData[i].shadowAtlasResRatio,
-					LightData[i].shadowAtlasLayer, 
-					LightData[i].PCFSamples, 
-					LightData[i].PCFRadius, 
-					LightData[i].BleedingReduction, 
-					LightData[i].shadowBias
+					light.pos, 
+					light.shadowMapCameraFar, 
+					light.shadowAtlasCoord, 
+					light.shadowAtlasResRatio,
+					light.shadowAtlasLayer, 
+					light.PCFSamples, 
+					light.PCFRadius, 
+					light.BleedingReduction, 
+					light.shadowBias
 				);
 			}
 
 			irradiance += Lo * shadow * attenuation * radiusCheck;
 		}
-		else if (LightData[i].type == 1) // Directional light
+		else if (light.type == 1) // Directional light
 		{
 			// lighting
-			vec3 lightDir = normalize(-LightData[i].dir);
-			vec3 Lo = PBR(fragPos, normal, fragToEye, albedo, metallic, roughness, lightDir, LightData[i].color * LightData[i].intensity);
+			vec3 lightDir = normalize(-light.dir);
+			vec3 Lo = PBR(fragPos, normal, fragToEye, albedo, metallic, roughness, lightDir, light.color * light.intensity);
 
 			// shadow
 			float depth = abs(viewPosDepth);
@@ -292,9 +365,9 @@ vec3 PBRLighting
 
 			vec3 cascadeMultiplier = vec3(1.0);
 
-			if (LightData[i].castShadow == 1)
+			if (light.castShadow == 1)
 			{
-				int numCascade = LightData[i].numOfCascades;
+				int numCascade = light.numOfCascades;
 				int cascadeOfThisPixel = numCascade - 1;
 
 				// Cascade selection by depth range.
@@ -328,65 +401,65 @@ vec3 PBRLighting
 
 				int layer = 0;
 				vec2 coord = vec2(0.0);
-				float shadowMapSize = LightData[i].shadowAtlasResRatio * SHADOW_ATLAS_SIZE;
-				ShadowAtlasLut(shadowMapSize, LightData[i].shadowAtlasCoord, cascadeOfThisPixel, layer, coord);
+				float shadowMapSize = light.shadowAtlasResRatio * SHADOW_ATLAS_SIZE;
+				ShadowAtlasLut(shadowMapSize, light.shadowAtlasCoord, cascadeOfThisPixel, layer, coord);
 
-				layer += LightData[i].shadowAtlasLayer;
+				layer += light.shadowAtlasLayer;
 
-				float rad = LightData[i].PCFRadius;
+				float rad = light.PCFRadius;
 				rad = rad * filterShrinkCoeff[cascadeOfThisPixel];
 
 				shadow = CalculateDirectionalShadow
 				(
 					fragPos, 
 					viewCamPos, 
-					LightData[i].projectionViewMatrices[cascadeOfThisPixel], 
+					FetchLightMatrix(i, cascadeOfThisPixel), 
 					coord / SHADOW_ATLAS_SIZE, // Convert the resolution to uv
-					LightData[i].shadowAtlasResRatio,	
+					light.shadowAtlasResRatio,	
 					layer, 
-					LightData[i].PCFSamples, 
+					light.PCFSamples, 
 					rad,
-					LightData[i].BleedingReduction,	
-					LightData[i].shadowBias
+					light.BleedingReduction,	
+					light.shadowBias
 				);
 			}
 
 			irradiance += Lo * shadow * cascadeMultiplier;
 		}
-		else // if (LightData[i].type == 3) Spot light
+		else // if (light.type == 3) Spot light
 		{
 			// radius check and attenuation
-			vec3 fragToLight = LightData[i].pos - fragPos;
+			vec3 fragToLight = light.pos - fragPos;
 			float lightDistance = length(fragToLight);
-			float radiusCheck = RadiusCheck(LightData[i].radius, lightDistance);
-			float attenuation = Attenuation(lightDistance, LightData[i].radius, 1.0, 0.09, 0.032);
+			float radiusCheck = RadiusCheck(light.radius, lightDistance);
+			float attenuation = Attenuation(lightDistance, light.radius, 1.0, 0.09, 0.032);
 
 			// Lighting angle and falloff
-			float theta = dot(-normalize(fragToLight), LightData[i].dir);
-			float epsilon = LightData[i].innAngle - LightData[i].outAngle;
-			float intensity = clamp((theta - LightData[i].outAngle) / epsilon, 0.0, 1.0);
+			float theta = dot(-normalize(fragToLight), light.dir);
+			float epsilon = light.innAngle - light.outAngle;
+			float intensity = clamp((theta - light.outAngle) / epsilon, 0.0, 1.0);
 
 			// lighting
-			vec3 lightDir = normalize(-LightData[i].dir);
-			vec3 Lo = PBR(fragPos, normal, fragToEye, albedo, metallic, roughness, lightDir, LightData[i].color * LightData[i].intensity);
+			vec3 lightDir = normalize(-light.dir);
+			vec3 Lo = PBR(fragPos, normal, fragToEye, albedo, metallic, roughness, lightDir, light.color * light.intensity);
 
 			// shadow
 			float shadow = 1.0;
-			if (LightData[i].castShadow == 1)
+			if (light.castShadow == 1)
 			{
 				shadow = CalculateSpotShadow
 				(
 					fragPos, 
-					LightData[i].pos, 
-					LightData[i].projectionViewMatrices[0], 
-					LightData[i].shadowMapCameraFar, 
-					LightData[i].shadowAtlasCoord / SHADOW_ATLAS_SIZE, // Convert the resolution to uv
-					LightData[i].shadowAtlasResRatio, 
-					LightData[i].shadowAtlasLayer, 
-					LightData[i].PCFSamples, 
-					LightData[i].PCFRadius, 
-					LightData[i].BleedingReduction,
-					LightData[i].shadowBias
+					light.pos, 
+					FetchLightMatrix(i, 0), 
+					light.shadowMapCameraFar, 
+					light.shadowAtlasCoord / SHADOW_ATLAS_SIZE, // Convert the resolution to uv
+					light.shadowAtlasResRatio, 
+					light.shadowAtlasLayer, 
+					light.PCFSamples, 
+					light.PCFRadius, 
+					light.BleedingReduction,
+					light.shadowBias
 				);
 			}
 
@@ -38,16 +38,24 @@ uniform float blendKeyFrameCount;
 uniform sampler2D s_texture2; // Blend animation data texture
 uniform sampler2D s_texture3; // Animation data texture
 
+// Each bone holds the 3 rows of its affine matrix, the last row is always (0, 0, 0, 1).
+// The 4th texel holds the translation's rounding error in half precision textures, zero otherwise.
 mat4 getMatrixFromTexture(sampler2D animDataTexture, float boneIndx, float keyframe, float numberOfKeyFrames)
 {
   float matrixPos   = boneIndx / numBones;
   float stepX       = 1.0 / (numBones * 4.0);
   vec2 moveToCenter = vec2(stepX / 2.0, 1.0 / (numberOfKeyFrames * 2.0));
 
-  return mat4(texture(animDataTexture, vec2(matrixPos, keyframe) + moveToCenter),
-              texture(animDataTexture, vec2(matrixPos + stepX, keyframe) + moveToCenter),
-              texture(animDataTexture, vec2(matrixPos + (stepX * 2.0), keyframe) + moveToCenter),
-              texture(animDataTexture, vec2(matrixPos + (stepX * 3.0), keyframe) + moveToCenter));
+  vec4 row0         = texture(animDataTexture, vec2(matrixPos, keyframe) + moveToCenter);
+  vec4 row1         = texture(animDataTexture, vec2(matrixPos + stepX, keyframe) + moveToCenter);
+  vec4 row2         = texture(animDataTexture, vec2(matrixPos + (stepX * 2.0), keyframe) + moveToCenter);
+  vec4 error        = texture(animDataTexture, vec2(matrixPos + (stepX * 3.0), keyframe) + moveToCenter);
+
+  row0.w           += error.x;
+  row1.w           += error.y;
+  row2.w           += error.z;
+
+  return transpose(mat4(row0, row1, row2, vec4(0.0, 0.0, 0.0, 1.0)));
 }
 
 // keyFramesData-> x: keyFrame1 y: keyFrame2 z: time w: key frame count
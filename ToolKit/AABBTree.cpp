@@ -8,14 +8,231 @@
 #include "AABBTree.h"
 
 #include "Entity.h"
+#include "Light.h"
 #include "MathUtil.h"
+#include "MeshComponent.h"
 #include "Primative.h"
+#include "SkeletonComponent.h"
+#include "Surface.h"
 #include "Threads.h"
 
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+  #include <xmmintrin.h>
+  #define TK_AABB_SSE
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+  #include <arm_neon.h>
+  #define TK_AABB_NEON
+#endif
+
 namespace ToolKit
 {
 
-  AABBTree::AABBTree() : m_root {nullNode}, m_nodeCapacity {32}, m_nodeCount {0}, m_threadTreshold(1000) { Reset(); }
+  // Four wide float operations for the wide tree tests.
+  // Maps to SSE on x86 (also emulated by wasm simd128), NEON on arm and falls back to scalar code.
+
+#if defined(TK_AABB_SSE)
+  typedef __m128 Float4;
+
+  static inline Float4 Load4(const float* v) { return _mm_load_ps(v); }
+
+  static inline Float4 Splat4(float v) { return _mm_set1_ps(v); }
+
+  static inline Float4 Add4(Float4 a, Float4 b) { return _mm_add_ps(a, b); }
+
+  static inline Float4 Mul4(Float4 a, Float4 b) { return _mm_mul_ps(a, b); }
+
+  /** Returns a bit mask which has the bit i set if a[i] < b[i]. */
+  static inline int LessMask4(Float4 a, Float4 b) { return _mm_movemask_ps(_mm_cmplt_ps(a, b)); }
+#elif defined(TK_AABB_NEON)
+  typedef float32x4_t Float4;
+
+  static inline Float4 Load4(const float* v) { return vld1q_f32(v); }
+
+  static inline Float4 Splat4(float v) { return vdupq_n_f32(v); }
+
+  static inline Float4 Add4(Float4 a, Float4 b) { return vaddq_f32(a, b); }
+
+  static inline Float4 Mul4(Float4 a, Float4 b) { return vmulq_f32(a, b); }
+
+  /** Returns a bit mask which has the bit i set if a[i] < b[i]. */
+  static inline int LessMask4(Float4 a, Float4 b)
+  {
+    uint32x4_t less = vcltq_f32(a, b);
+    return (vgetq_lane_u32(less, 0) & 1) | (vgetq_lane_u32(less, 1) & 2) | (vgetq_lane_u32(less, 2) & 4) |
+           (vgetq_lane_u32(less, 3) & 8);
+  }
+#else
+  struct Float4
+  {
+    float v[4];
+  };
+
+  static inline Float4 Load4(const float* v) { return {v[0], v[1], v[2], v[3]}; }
+
+  static inline Float4 Splat4(float v) { return {v, v, v, v}; }
+
+  static inline Float4 Add4(Float4 a, Float4 b)
+  {
+    return {a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3]};
+  }
+
+  static inline Float4 Mul4(Float4 a, Float4 b)
+  {
+    return {a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3]};
+  }
+
+  /** Returns a bit mask which has the bit i set if a[i] < b[i]. */
+  static inline int LessMask4(Float4 a, Float4 b)
+  {
+    return (int) (a.v[0] < b.v[0]) | (int) (a.v[1] < b.v[1]) << 1 | (int) (a.v[2] < b.v[2]) << 2 |
+           (int) (a.v[3] < b.v[3]) << 3;
+  }
+#endif
+
+  /**
+   * Tests the four child boxes of the wide node against the frustum at once.
+   * Lanes that are outside of any plane are set in the outside mask, lanes that cross any plane in the intersect mask.
+   * Lanes which are not set in either mask are fully inside.
+   */
+  static void FrustumBox4Intersection(const Frustum& frustum,
+                                      const AABBTree::AABBNode4& node,
+                                      int& outsideMask,
+                                      int& intersectMask)
+  {
+    outsideMask       = 0;
+    intersectMask     = 0;
+
+    const Float4 zero = Splat4(0.0f);
+    for (int i = 0; i < 6; i++)
+    {
+      const PlaneEquation& plane = frustum.planes[i];
+
+      // Positive and negative vertices of the boxes with respect to the plane normal.
+      bool xPositive             = plane.normal.x >= 0.0f;
+      bool yPositive             = plane.normal.y >= 0.0f;
+      bool zPositive             = plane.normal.z >= 0.0f;
+
+      Float4 px                  = Load4(xPositive ? node.maxX : node.minX);
+      Float4 py                  = Load4(yPositive ? node.maxY : node.minY);
+      Float4 pz                  = Load4(zPositive ? node.maxZ : node.minZ);
+
+      Float4 nx                  = Load4(xPositive ? node.minX : node.maxX);
+      Float4 ny                  = Load4(yPositive ? node.minY : node.maxY);
+      Float4 nz                  = Load4(zPositive ? node.minZ : node.maxZ);
+
+      Float4 normalX             = Splat4(plane.normal.x);
+      Float4 normalY             = Splat4(plane.normal.y);
+      Float4 normalZ             = Splat4(plane.normal.z);
+      Float4 d                   = Splat4(plane.d);
+
+      Float4 pDist               = Add4(Add4(Mul4(normalX, px), Mul4(normalY, py)), Add4(Mul4(normalZ, pz), d));
+      Float4 nDist               = Add4(Add4(Mul4(normalX, nx), Mul4(normalY, ny)), Add4(Mul4(normalZ, nz), d));
+
+      outsideMask               |= LessMask4(pDist, zero);
+      intersectMask             |= LessMask4(nDist, zero);
+    }
+
+    intersectMask &= ~outsideMask;
+  }
+
+  /**
+   * Tests the four child boxes of the wide node against the box at once. Same semantics with BoxBoxIntersection where
+   * the child boxes are the second box. Masks are filled same as FrustumBox4Intersection.
+   */
+  static void BoxBox4Intersection(const BoundingBox& box,
+                                  const AABBTree::AABBNode4& node,
+                                  int& outsideMask,
+                                  int& intersectMask)
+  {
+    Float4 minX   = Load4(node.minX);
+    Float4 minY   = Load4(node.minY);
+    Float4 minZ   = Load4(node.minZ);
+    Float4 maxX   = Load4(node.maxX);
+    Float4 maxY   = Load4(node.maxY);
+    Float4 maxZ   = Load4(node.maxZ);
+
+    Float4 bMinX  = Splat4(box.min.x);
+    Float4 bMinY  = Splat4(box.min.y);
+    Float4 bMinZ  = Splat4(box.min.z);
+    Float4 bMaxX  = Splat4(box.max.x);
+    Float4 bMaxY  = Splat4(box.max.y);
+    Float4 bMaxZ  = Splat4(box.max.z);
+
+    // Separated on any axis.
+    outsideMask   = LessMask4(bMaxX, minX) | LessMask4(maxX, bMinX) | LessMask4(bMaxY, minY) |
+                  LessMask4(maxY, bMinY) | LessMask4(bMaxZ, minZ) | LessMask4(maxZ, bMinZ);
+
+    // Not contained by the box.
+    intersectMask = LessMask4(minX, bMinX) | LessMask4(bMaxX, maxX) | LessMask4(minY, bMinY) |
+                    LessMask4(bMaxY, maxY) | LessMask4(minZ, bMinZ) | LessMask4(bMaxZ, maxZ);
+
+    intersectMask &= ~outsideMask;
+  }
+
+  /** Dispatches the wide node test for the volume type. */
+  static inline void WideNodeIntersection(const Frustum& frustum,
+                                          const AABBTree::AABBNode4& node,
+                                          int& outsideMask,
+                                          int& intersectMask)
+  {
+    FrustumBox4Intersection(frustum, node, outsideMask, intersectMask);
+  }
+
+  static inline void WideNodeIntersection(const BoundingBox& box,
+                                          const AABBTree::AABBNode4& node,
+                                          int& outsideMask,
+                                          int& intersectMask)
+  {
+    BoxBox4Intersection(box, node, outsideMask, intersectMask);
+  }
+
+  /** Returns the categories of the entity to store in its leaf. */
+  static uint GetEntityCategories(Entity* ntt)
+  {
+    uint categories = AABBTree::CategoryNone;
+    if (ntt->GetVisibleVal())
+    {
+      categories |= AABBTree::CategoryVisible;
+    }
+
+    if (MeshComponent* meshComp = ntt->GetComponentFast<MeshComponent>())
+    {
+      categories |= AABBTree::CategoryMesh;
+      if (meshComp->GetCastShadowVal())
+      {
+        categories |= AABBTree::CategoryShadowCaster;
+      }
+    }
+
+    if (ntt->IsA<Light>())
+    {
+      categories |= AABBTree::CategoryLight;
+    }
+
+    if (ntt->IsA<Surface>())
+    {
+      categories |= AABBTree::CategoryUI;
+    }
+
+    if (ntt->IsA<Billboard>())
+    {
+      categories |= AABBTree::CategoryEditorOnly;
+    }
+
+    return categories;
+  }
+
+  /** Returns true if the subtree with the categories may contain entities that pass the include mask. */
+  static inline bool SubtreeMayPass(uint categories, uint includeMask)
+  {
+    return includeMask == AABBTree::CategoryNone || (categories & includeMask) != 0;
+  }
+
+  AABBTree::AABBTree()
+      : m_root {nullNode}, m_leafMargin {0.1f}, m_nodeCapacity {32}, m_nodeCount {0}, m_threadTreshold(1000)
+  {
+    Reset();
+  }
 
   AABBTree::~AABBTree()
   {
@@ -40,15 +257,19 @@ namespace ToolKit
         m_nodes[i].entity.reset();
       }
 
-      m_nodes[i].next   = i + 1;
-      m_nodes[i].parent = i;
-      m_nodes[i].leafs.clear();
+      m_nodes[i].next    = i + 1;
+      m_nodes[i].parent  = i;
+      m_nodes[i].invalid = false;
     }
-    m_nodes[m_nodeCapacity - 1].next   = nullNode;
-    m_nodes[m_nodeCapacity - 1].parent = m_nodeCapacity - 1;
+    m_nodes[m_nodeCapacity - 1].next    = nullNode;
+    m_nodes[m_nodeCapacity - 1].parent  = m_nodeCapacity - 1;
+    m_nodes[m_nodeCapacity - 1].invalid = false;
 
-    m_freeList                         = 0;
+    m_freeList                          = 0;
     m_invalidNodes.clear();
+
+    m_wideNodes.clear();
+    m_wideTreeDirty = true;
   }
 
   AABBNodeProxy AABBTree::CreateNode(EntityWeakPtr entity, const BoundingBox& aabb)
@@ -57,24 +278,33 @@ namespace ToolKit
 
     if (EntityPtr ntt = entity.lock())
     {
-      ntt->m_aabbTreeNodeProxy = newNode;
+      ntt->m_aabbTreeNodeProxy    = newNode;
+      m_nodes[newNode].categories = GetEntityCategories(ntt.get());
+    }
+    else
+    {
+      m_nodes[newNode].categories = CategoryNone;
     }
 
     // Fatten the aabb
-    m_nodes[newNode].aabb.max = aabb.max;
-    m_nodes[newNode].aabb.min = aabb.min;
-    m_nodes[newNode].entity   = entity;
-    m_nodes[newNode].parent   = nullNode;
-
-    // Insert a reference to self to create leafs struct properly in the tree.
-    m_nodes[newNode].leafs.insert(newNode);
+    m_nodes[newNode].aabb       = FattenLeafBox(aabb);
+    m_nodes[newNode].entityAabb = aabb;
+    m_nodes[newNode].entity     = entity;
+    m_nodes[newNode].parent     = nullNode;
 
     InsertLeaf(newNode);
 
     return newNode;
   }
 
-  void AABBTree::Invalidate(AABBNodeProxy node) { m_invalidNodes.insert(node); }
+  void AABBTree::Invalidate(AABBNodeProxy node)
+  {
+    if (!m_nodes[node].invalid)
+    {
+      m_nodes[node].invalid = true;
+      m_invalidNodes.push_back(node);
+    }
+  }
 
   void AABBTree::UpdateTree()
   {
@@ -83,22 +313,87 @@ namespace ToolKit
       return;
     }
 
-    // Update node will invalidate m_invalidNodes set, so this copy is needed.
-    AABBNodeSet invalidNodes = m_invalidNodes;
-    for (AABBNodeProxy node : invalidNodes)
+    // Refresh entity boxes and categories, find the leaves that are not covered by their enlarged boxes anymore.
+    NodeProxyArray movedLeaves;
+    NodeProxyArray recategorizedLeaves;
+    for (AABBNodeProxy node : m_invalidNodes)
     {
-      RemoveLeaf(node);
+      // Removed from the tree, or a duplicate of a reused node that is already updated.
+      AABBNode& leaf = m_nodes[node];
+      if (!leaf.invalid)
+      {
+        continue;
+      }
 
-      BoundingBox aabb = m_nodes[node].aabb;
-      if (!m_nodes[node].entity.expired())
+      leaf.invalid = false;
+      if (EntityPtr ntt = leaf.entity.lock())
       {
-        EntityPtr ntt = m_nodes[node].entity.lock();
-        aabb          = ntt->GetBoundingBox(true);
+        leaf.entityAabb = ntt->GetBoundingBox(true);
+
+        uint categories = GetEntityCategories(ntt.get());
+        if (leaf.categories != categories)
+        {
+          leaf.categories = categories;
+          recategorizedLeaves.push_back(node);
+        }
+      }
+
+      if (!leaf.aabb.Contains(leaf.entityAabb))
+      {
+        movedLeaves.push_back(node);
+        continue;
+      }
+
+      // Still inside of its enlarged box, the tree is intact. Leaves that shrunk a lot get a tighter enlarged box in
+      // place, their ancestors still contain it and are tightened by the next refit or rebuild.
+      BoundingBox fatBox = FattenLeafBox(leaf.entityAabb);
+      if (fatBox.HalfSurfaceArea() * 4.0f < leaf.aabb.HalfSurfaceArea())
+      {
+        leaf.aabb = fatBox;
+      }
+
+      // Only the entity box in the wide tree changes.
+      UpdateWideLane(node);
+    }
+
+    m_invalidNodes.clear();
+
+    int leafCount = (m_nodeCount + 1) / 2;
+    if ((int) movedLeaves.size() * 4 > leafCount)
+    {
+      // Many leaves are moved, enlarge their boxes in place and refit the tree at once.
+      for (AABBNodeProxy node : movedLeaves)
+      {
+        m_nodes[node].aabb = FattenLeafBox(m_nodes[node].entityAabb);
+      }
+
+      RefitTree();
+      RefitWideTree();
+    }
+    else
+    {
+      for (AABBNodeProxy node : movedLeaves)
+      {
+        RemoveLeaf(node);
+        m_nodes[node].aabb = FattenLeafBox(m_nodes[node].entityAabb);
+        InsertLeaf(node);
       }
 
-      m_nodes[node].aabb = aabb;
+      // Propagate the changed categories to the ancestors, until an ancestor's categories do not change.
+      for (AABBNodeProxy node : recategorizedLeaves)
+      {
+        for (AABBNodeProxy ancestor = m_nodes[node].parent; ancestor != nullNode; ancestor = m_nodes[ancestor].parent)
+        {
+          uint categories = ChildCategories(ancestor);
+          if (m_nodes[ancestor].categories == categories)
+          {
+            break;
+          }
 
-      InsertLeaf(node);
+          m_nodes[ancestor].categories = categories;
+          UpdateWideLane(ancestor);
+        }
+      }
     }
   }
 
@@ -133,278 +428,1157 @@ namespace ToolKit
         stack.emplace_back(m_nodes[current].child1);
         stack.emplace_back(m_nodes[current].child2);
       }
-
-      const AABBNode* node = &m_nodes[current];
-      callback(node);
+
+      const AABBNode* node = &m_nodes[current];
+      callback(node);
+    }
+  }
+
+  void AABBTree::Rebuild()
+  {
+    // Refresh the invalid leaves, they are placed properly with the rebuild.
+    for (AABBNodeProxy node : m_invalidNodes)
+    {
+      AABBNode& leaf = m_nodes[node];
+      if (!leaf.invalid)
+      {
+        continue;
+      }
+
+      leaf.invalid = false;
+      if (EntityPtr ntt = leaf.entity.lock())
+      {
+        leaf.entityAabb = ntt->GetBoundingBox(true);
+        leaf.aabb       = FattenLeafBox(leaf.entityAabb);
+        leaf.categories = GetEntityCategories(ntt.get());
+      }
+    }
+    m_invalidNodes.clear();
+    m_wideTreeDirty = true;
+
+    BuildLeafArray leaves;
+    leaves.reserve(m_nodeCount);
+
+    // Collect all leaves
+    for (int32 i = 0; i < m_nodeCapacity; ++i)
+    {
+      // Already in the free list
+      if (m_nodes[i].parent == i)
+      {
+        continue;
+      }
+
+      // Clean the leaf
+      if (m_nodes[i].IsLeaf())
+      {
+        m_nodes[i].parent = nullNode;
+        leaves.push_back({i, m_nodes[i].aabb.GetCenter()});
+      }
+      else
+      {
+        // Free the internal node
+        FreeNode(i);
+      }
+    }
+
+    if (leaves.empty())
+    {
+      m_root = nullNode;
+      return;
+    }
+
+    // A binary tree with n leaves has n - 1 internal nodes. Allocate them up front, so that subtrees can be built
+    // concurrently without touching the free list.
+    NodeProxyArray internals(leaves.size() - 1);
+    for (AABBNodeProxy& node : internals)
+    {
+      node = AllocateNode();
+    }
+
+    BuildRange rootRange = {0, (int) leaves.size(), 0, nullNode};
+    m_root               = BuildRangeRoot(rootRange, leaves, internals);
+
+    int threadCount      = GetWorkerManager()->GetThreadCount(WorkerManager::FramePool);
+    if (threadCount == 0 || (int) leaves.size() < m_threadTreshold)
+    {
+      BuildSubtree(rootRange, leaves, internals, 0, nullptr, nullptr);
+      return;
+    }
+
+    // Split the top of the tree serially until there are enough ranges to keep all threads busy.
+    int grainSize = glm::max(m_threadTreshold / 4, (int) leaves.size() / (threadCount * 4));
+
+    BuildRangeArray deferredRanges;
+    NodeProxyArray refitNodes;
+    BuildSubtree(rootRange, leaves, internals, grainSize, &deferredRanges, &refitNodes);
+
+    // Build the subtrees in parallel. Each range writes to its own leaves and internal nodes.
+    std::for_each(TKExecBy(WorkerManager::FramePool),
+                  deferredRanges.begin(),
+                  deferredRanges.end(),
+                  [&](const BuildRange& range) -> void
+                  { BuildSubtree(range, leaves, internals, 0, nullptr, nullptr); });
+
+    // Fit the top of the tree to the subtrees in bottom up order.
+    for (AABBNodeProxy node : refitNodes)
+    {
+      AABBNode& internal  = m_nodes[node];
+      internal.aabb       = BoundingBox::Union(m_nodes[internal.child1].aabb, m_nodes[internal.child2].aabb);
+      internal.categories = ChildCategories(node);
+    }
+  }
+
+  AABBNodeProxy AABBTree::BuildRangeRoot(const BuildRange& range,
+                                         const BuildLeafArray& leaves,
+                                         const NodeProxyArray& internals) const
+  {
+    // Single leaf ranges are the leaf itself, otherwise the first internal node of the range is the root.
+    return range.end - range.begin == 1 ? leaves[range.begin].node : internals[range.slot];
+  }
+
+  void AABBTree::BuildSubtree(const BuildRange& range,
+                              BuildLeafArray& leaves,
+                              const NodeProxyArray& internals,
+                              int grainSize,
+                              BuildRangeArray* deferredRanges,
+                              NodeProxyArray* refitNodes)
+  {
+    AABBNodeProxy root   = BuildRangeRoot(range, leaves, internals);
+    m_nodes[root].parent = range.parent;
+
+    int count            = range.end - range.begin;
+    if (count == 1)
+    {
+      return;
+    }
+
+    if (deferredRanges != nullptr && count <= grainSize)
+    {
+      deferredRanges->push_back(range);
+      return;
+    }
+
+    int mid = SplitBinnedSAH(leaves, range.begin, range.end);
+
+    // Left subtree uses the internal nodes right after the root, right subtree uses the ones after the left subtree.
+    BuildRange left      = {range.begin, mid, range.slot + 1, root};
+    BuildRange right     = {mid, range.end, range.slot + (mid - range.begin), root};
+
+    m_nodes[root].child1 = BuildRangeRoot(left, leaves, internals);
+    m_nodes[root].child2 = BuildRangeRoot(right, leaves, internals);
+
+    BuildSubtree(left, leaves, internals, grainSize, deferredRanges, refitNodes);
+    BuildSubtree(right, leaves, internals, grainSize, deferredRanges, refitNodes);
+
+    if (refitNodes != nullptr)
+    {
+      // Children may be deferred, fit after they are built.
+      refitNodes->push_back(root);
+    }
+    else
+    {
+      AABBNode& internal  = m_nodes[root];
+      internal.aabb       = BoundingBox::Union(m_nodes[internal.child1].aabb, m_nodes[internal.child2].aabb);
+      internal.categories = ChildCategories(root);
+    }
+  }
+
+  int AABBTree::SplitBinnedSAH(BuildLeafArray& leaves, int begin, int end) const
+  {
+    constexpr int binCount = 16;
+
+    BoundingBox centerBounds;
+    for (int i = begin; i < end; i++)
+    {
+      centerBounds.UpdateBoundary(leaves[i].center);
+    }
+
+    // Bin along the longest axis of the centers.
+    Vec3 extent = centerBounds.max - centerBounds.min;
+    int axis    = 0;
+    if (extent.y > extent[axis])
+    {
+      axis = 1;
+    }
+
+    if (extent.z > extent[axis])
+    {
+      axis = 2;
+    }
+
+    int mid = begin + (end - begin) / 2;
+    if (extent[axis] <= TK_FLT_MIN)
+    {
+      // All centers are at the same position, any split is equally good.
+      return mid;
+    }
+
+    struct Bin
+    {
+      BoundingBox aabb;
+      int count = 0;
+    };
+
+    Bin bins[binCount];
+    float binScale = binCount / extent[axis];
+    float binMin   = centerBounds.min[axis];
+
+    auto binIndex  = [binScale, binMin, axis](const BuildLeaf& leaf) -> int
+    { return glm::min(binCount - 1, (int) ((leaf.center[axis] - binMin) * binScale)); };
+
+    for (int i = begin; i < end; i++)
+    {
+      Bin& bin = bins[binIndex(leaves[i])];
+      bin.aabb.UpdateBoundary(m_nodes[leaves[i].node].aabb);
+      bin.count++;
+    }
+
+    // Sweep from right to accumulate the costs of the right sides of the split planes.
+    float rightCosts[binCount - 1];
+    BoundingBox rightBox;
+    int rightCount = 0;
+    for (int i = binCount - 1; i > 0; i--)
+    {
+      rightBox.UpdateBoundary(bins[i].aabb);
+      rightCount        += bins[i].count;
+      rightCosts[i - 1]  = rightCount == 0 ? 0.0f : rightCount * rightBox.HalfSurfaceArea();
+    }
+
+    // Sweep from left and find the split plane with the lowest cost.
+    float bestCost = TK_FLT_MAX;
+    int bestSplit  = -1;
+    BoundingBox leftBox;
+    int leftCount = 0;
+    for (int i = 0; i < binCount - 1; i++)
+    {
+      leftBox.UpdateBoundary(bins[i].aabb);
+      leftCount += bins[i].count;
+
+      if (leftCount == 0 || leftCount == end - begin)
+      {
+        continue;
+      }
+
+      float cost = leftCount * leftBox.HalfSurfaceArea() + rightCosts[i];
+      if (cost < bestCost)
+      {
+        bestCost  = cost;
+        bestSplit = i;
+      }
+    }
+
+    if (bestSplit != -1)
+    {
+      auto midItr = std::partition(leaves.begin() + begin,
+                                   leaves.begin() + end,
+                                   [&](const BuildLeaf& leaf) -> bool { return binIndex(leaf) <= bestSplit; });
+
+      mid         = (int) (midItr - leaves.begin());
+    }
+
+    if (mid == begin || mid == end)
+    {
+      // Degenerate partition, split from the median.
+      mid = begin + (end - begin) / 2;
+      std::nth_element(leaves.begin() + begin,
+                       leaves.begin() + mid,
+                       leaves.begin() + end,
+                       [axis](const BuildLeaf& a, const BuildLeaf& b) -> bool
+                       { return a.center[axis] < b.center[axis]; });
+    }
+
+    return mid;
+  }
+
+  const BoundingBox& AABBTree::GetRootBoundingBox()
+  {
+    UpdateTree();
+
+    if (m_root != nullNode)
+    {
+      return m_nodes[m_root].aabb;
+    }
+
+    return infinitesimalBox;
+  }
+
+  void AABBTree::SetLeafMargin(float margin) { m_leafMargin = glm::max(margin, 0.0f); }
+
+  float AABBTree::GetLeafMargin() const { return m_leafMargin; }
+
+  uint AABBTree::ChildCategories(AABBNodeProxy node) const
+  {
+    return m_nodes[m_nodes[node].child1].categories | m_nodes[m_nodes[node].child2].categories;
+  }
+
+  BoundingBox AABBTree::FattenLeafBox(const BoundingBox& entityAabb) const
+  {
+    if (!entityAabb.IsValid())
+    {
+      return entityAabb;
+    }
+
+    const Vec3 margin(m_leafMargin);
+    return BoundingBox(entityAabb.min - margin, entityAabb.max + margin);
+  }
+
+  void AABBTree::RefitTree()
+  {
+    if (m_root == nullNode)
+    {
+      return;
+    }
+
+    int threadCount = 0;
+    if (m_nodeCount > m_threadTreshold)
+    {
+      threadCount = GetWorkerManager()->GetThreadCount(WorkerManager::FramePool);
+    }
+
+    // Expand the top of the tree breadth first until there are enough subtrees to keep all workers busy.
+    NodeProxyArray topNodes;
+    std::deque<AABBNodeProxy> subtrees;
+    subtrees.push_back(m_root);
+
+    const size_t subtreeTarget = (size_t) glm::max(threadCount * 4, 1);
+    while (!subtrees.empty() && subtrees.size() < subtreeTarget)
+    {
+      AABBNodeProxy node = subtrees.front();
+      if (m_nodes[node].IsLeaf())
+      {
+        break;
+      }
+
+      subtrees.pop_front();
+      topNodes.push_back(node);
+      subtrees.push_back(m_nodes[node].child1);
+      subtrees.push_back(m_nodes[node].child2);
+    }
+
+    using poolstl::iota_iter;
+    std::for_each(TKExecByConditional(threadCount > 0, WorkerManager::FramePool),
+                  iota_iter<size_t>(0),
+                  iota_iter<size_t>(subtrees.size()),
+                  [&](size_t subtreeIndex) -> void { RefitSubtree(subtrees[subtreeIndex]); });
+
+    // Top nodes are in top down order, refit them in reverse after their subtrees.
+    for (auto itr = topNodes.rbegin(); itr != topNodes.rend(); itr++)
+    {
+      AABBNode& node  = m_nodes[*itr];
+      node.aabb       = BoundingBox::Union(m_nodes[node.child1].aabb, m_nodes[node.child2].aabb);
+      node.categories = ChildCategories(*itr);
+    }
+  }
+
+  void AABBTree::RefitSubtree(AABBNodeProxy subtreeRoot)
+  {
+    // Collect internal nodes in top down order, so that the reverse order visits children before their parents.
+    NodeProxyArray internals;
+    NodeProxyArray stack;
+    stack.push_back(subtreeRoot);
+
+    while (!stack.empty())
+    {
+      AABBNodeProxy node = stack.back();
+      stack.pop_back();
+
+      if (!m_nodes[node].IsLeaf())
+      {
+        internals.push_back(node);
+        stack.push_back(m_nodes[node].child1);
+        stack.push_back(m_nodes[node].child2);
+      }
+    }
+
+    for (auto itr = internals.rbegin(); itr != internals.rend(); itr++)
+    {
+      AABBNode& node  = m_nodes[*itr];
+      node.aabb       = BoundingBox::Union(m_nodes[node.child1].aabb, m_nodes[node.child2].aabb);
+      node.categories = ChildCategories(*itr);
+    }
+  }
+
+  AABBNodeProxy AABBTree::AllocateNode()
+  {
+    if (m_freeList == nullNode)
+    {
+      assert(m_nodeCount == m_nodeCapacity);
+
+      // Grow the node pool
+      m_nodeCapacity += m_nodeCapacity / 2;
+      m_nodes.resize(m_nodeCapacity);
+
+      // Build a linked list for the free list.
+      for (int32 i = m_nodeCount; i < m_nodeCapacity - 1; ++i)
+      {
+        m_nodes[i].next   = i + 1;
+        m_nodes[i].parent = i;
+      }
+      m_nodes[m_nodeCapacity - 1].parent = m_nodeCapacity - 1;
+      m_nodes[m_nodeCapacity - 1].next   = nullNode;
+
+      m_freeList                         = m_nodeCount;
+    }
+
+    AABBNodeProxy node    = m_freeList;
+    m_freeList            = m_nodes[node].next;
+    m_nodes[node].parent  = nullNode;
+    m_nodes[node].child1  = nullNode;
+    m_nodes[node].child2  = nullNode;
+    m_nodes[node].invalid = false;
+    m_nodes[node].entity.reset();
+    ++m_nodeCount;
+
+    return node;
+  }
+
+  /** Test tree against a frustum. */
+  template TK_API EntityRawPtrArray AABBTree::VolumeQuery(const Frustum& frustum,
+                                                          bool threaded,
+                                                          uint includeMask,
+                                                          uint excludeMask);
+
+  /** Test tree against a box. */
+  template TK_API EntityRawPtrArray AABBTree::VolumeQuery(const BoundingBox& box,
+                                                          bool threaded,
+                                                          uint includeMask,
+                                                          uint excludeMask);
+
+  template <typename VolumeType>
+  EntityRawPtrArray AABBTree::VolumeQuery(const VolumeType& vol, bool threaded, uint includeMask, uint excludeMask)
+  {
+    UpdateTree();
+
+    EntityRawPtrArray entities;
+    if (m_root == nullNode)
+    {
+      return entities;
+    }
+
+    if (m_wideTreeDirty)
+    {
+      BuildWideTree();
+    }
+
+    int threadCount = 0;
+    if (threaded && m_nodeCount > m_threadTreshold)
+    {
+      threadCount = GetWorkerManager()->GetThreadCount(WorkerManager::FramePool);
+    }
+
+    if (threadCount == 0)
+    {
+      WideVolumeQuery(vol, 0, includeMask, excludeMask, entities);
+      return entities;
+    }
+
+    // Expand the top of the tree breadth first until there are enough subtrees to keep all workers busy.
+    // Fully inside subtrees are final tasks, intersecting ones are expanded further.
+    struct QueryTask
+    {
+      int wideNode;
+      bool inside;
+    };
+
+    FrameArray<QueryTask> tasks(FrameArena::Get());
+    std::pmr::deque<int> expandQueue(FrameArena::Get());
+    expandQueue.push_back(0);
+
+    const int taskTarget = threadCount * 4;
+    while (!expandQueue.empty() && (int) (expandQueue.size() + tasks.size()) < taskTarget)
+    {
+      const AABBNode4& node = m_wideNodes[expandQueue.front()];
+      expandQueue.pop_front();
+
+      int outsideMask       = 0;
+      int intersectMask     = 0;
+      WideNodeIntersection(vol, node, outsideMask, intersectMask);
+
+      for (int lane = 0; lane < 4; lane++)
+      {
+        int child = node.children[lane];
+        if (child == nullNode || (outsideMask & (1 << lane)) || !SubtreeMayPass(node.categories[lane], includeMask))
+        {
+          continue;
+        }
+
+        if (child < nullNode)
+        {
+          if ((node.categories[lane] & excludeMask) != 0)
+          {
+            continue;
+          }
+
+          if (EntityPtr ntt = m_nodes[DecodeWideLeaf(child)].entity.lock())
+          {
+            entities.push_back(ntt.get());
+          }
+        }
+        else if (intersectMask & (1 << lane))
+        {
+          expandQueue.push_back(child);
+        }
+        else
+        {
+          tasks.push_back({child, true});
+        }
+      }
+    }
+
+    for (int wideNode : expandQueue)
+    {
+      tasks.push_back({wideNode, false});
+    }
+
+    // Each task writes to its own buffer. Buffers belong to the querying thread, so that queries from different
+    // threads don't share them, and are kept to reuse their memory in the next queries. Tasks run on the workers,
+    // they access the buffers of the querying thread with the reference.
+    static thread_local std::vector<EntityRawPtrArray> threadQueryBuffers;
+    std::vector<EntityRawPtrArray>& queryBuffers = threadQueryBuffers;
+    if (queryBuffers.size() < tasks.size())
+    {
+      queryBuffers.resize(tasks.size());
+    }
+
+    using poolstl::iota_iter;
+    std::for_each(TKExecBy(WorkerManager::FramePool),
+                  iota_iter<size_t>(0),
+                  iota_iter<size_t>(tasks.size()),
+                  [&](size_t taskIndex) -> void
+                  {
+                    const QueryTask& task     = tasks[taskIndex];
+                    EntityRawPtrArray& buffer = queryBuffers[taskIndex];
+                    buffer.clear();
+
+                    if (task.inside)
+                    {
+                      FrameArray<int> stack(FrameArena::Get());
+                      CollectWideLeaves(task.wideNode, includeMask, excludeMask, buffer, stack);
+                    }
+                    else
+                    {
+                      WideVolumeQuery(vol, task.wideNode, includeMask, excludeMask, buffer);
+                    }
+                  });
+
+    // Merge the results.
+    size_t resultCount = entities.size();
+    for (size_t i = 0; i < tasks.size(); i++)
+    {
+      resultCount += queryBuffers[i].size();
+    }
+
+    entities.reserve(resultCount);
+    for (size_t i = 0; i < tasks.size(); i++)
+    {
+      entities.insert(entities.end(), queryBuffers[i].begin(), queryBuffers[i].end());
+    }
+
+    return entities;
+  }
+
+  void AABBTree::BuildWideTree()
+  {
+    m_wideNodes.clear();
+    m_wideTreeDirty = false;
+
+    if (m_root == nullNode)
+    {
+      return;
+    }
+
+    // Each item is a binary node whose descendants are collapsed into the given wide node.
+    struct CollapseItem
+    {
+      AABBNodeProxy node;
+      int wideNode;
+    };
+
+    std::vector<CollapseItem> stack;
+
+    m_wideNodes.reserve(m_nodeCount / 3 + 1);
+    m_wideNodes.emplace_back();
+    stack.push_back({m_root, 0});
+    m_nodes[m_root].wideLane = nullNode;
+
+    while (!stack.empty())
+    {
+      CollapseItem item = stack.back();
+      stack.pop_back();
+
+      // Gather up to four descendants by opening the internal candidate with the largest surface area.
+      AABBNodeProxy candidates[4];
+      int candidateCount = 0;
+
+      if (m_nodes[item.node].IsLeaf())
+      {
+        candidates[candidateCount++] = item.node;
+      }
+      else
+      {
+        candidates[candidateCount++] = m_nodes[item.node].child1;
+        candidates[candidateCount++] = m_nodes[item.node].child2;
+
+        while (candidateCount < 4)
+        {
+          int bestCandidate = -1;
+          float bestArea    = -1.0f;
+          for (int i = 0; i < candidateCount; i++)
+          {
+            const AABBNode& candidate = m_nodes[candidates[i]];
+            if (!candidate.IsLeaf() && candidate.aabb.HalfSurfaceArea() > bestArea)
+            {
+              bestArea      = candidate.aabb.HalfSurfaceArea();
+              bestCandidate = i;
+            }
+          }
+
+          if (bestCandidate == -1)
+          {
+            break;
+          }
+
+          AABBNodeProxy opened         = candidates[bestCandidate];
+          candidates[bestCandidate]    = m_nodes[opened].child1;
+          candidates[candidateCount++] = m_nodes[opened].child2;
+          m_nodes[opened].wideLane     = nullNode;
+        }
+      }
+
+      for (int lane = 0; lane < 4; lane++)
+      {
+        int child       = nullNode;
+        BoundingBox box = BoundingBox(); // Empty lanes never pass the tests.
+        uint categories = CategoryNone;
+
+        if (lane < candidateCount)
+        {
+          AABBNode& candidate = m_nodes[candidates[lane]];
+          box                 = candidate.IsLeaf() ? candidate.entityAabb : candidate.aabb;
+          categories          = candidate.categories;
+          candidate.wideLane  = item.wideNode * 4 + lane;
+
+          if (candidate.IsLeaf())
+          {
+            child = EncodeWideLeaf(candidates[lane]);
+          }
+          else
+          {
+            // Emplace invalidates the references, access the wide node with index.
+            child = (int) m_wideNodes.size();
+            m_wideNodes.emplace_back();
+            stack.push_back({candidates[lane], child});
+          }
+        }
+
+        AABBNode4& wideNode       = m_wideNodes[item.wideNode];
+        wideNode.minX[lane]       = box.min.x;
+        wideNode.minY[lane]       = box.min.y;
+        wideNode.minZ[lane]       = box.min.z;
+        wideNode.maxX[lane]       = box.max.x;
+        wideNode.maxY[lane]       = box.max.y;
+        wideNode.maxZ[lane]       = box.max.z;
+        wideNode.children[lane]   = child;
+        wideNode.categories[lane] = categories;
+      }
+    }
+  }
+
+  void AABBTree::UpdateWideLane(AABBNodeProxy node)
+  {
+    const AABBNode& binaryNode = m_nodes[node];
+    if (m_wideTreeDirty || binaryNode.wideLane == nullNode)
+    {
+      return;
+    }
+
+    AABBNode4& wideNode       = m_wideNodes[binaryNode.wideLane / 4];
+    int lane                  = binaryNode.wideLane % 4;
+    const BoundingBox& box    = binaryNode.IsLeaf() ? binaryNode.entityAabb : binaryNode.aabb;
+
+    wideNode.minX[lane]       = box.min.x;
+    wideNode.minY[lane]       = box.min.y;
+    wideNode.minZ[lane]       = box.min.z;
+    wideNode.maxX[lane]       = box.max.x;
+    wideNode.maxY[lane]       = box.max.y;
+    wideNode.maxZ[lane]       = box.max.z;
+    wideNode.categories[lane] = binaryNode.categories;
+  }
+
+  void AABBTree::RefitWideTree()
+  {
+    if (m_wideTreeDirty)
+    {
+      return;
+    }
+
+    for (AABBNodeProxy node = 0; node < m_nodeCapacity; node++)
+    {
+      // Skip the nodes in the free list.
+      if (m_nodes[node].parent != node)
+      {
+        UpdateWideLane(node);
+      }
     }
   }
 
-  void AABBTree::Rebuild()
+  template <typename VolumeType>
+  void AABBTree::WideVolumeQuery(const VolumeType& vol,
+                                 int wideRoot,
+                                 uint includeMask,
+                                 uint excludeMask,
+                                 EntityRawPtrArray& result) const
   {
-    m_invalidNodes.clear();
-
-    // Rebuild tree with bottom up approach.
-    std::vector<AABBNodeProxy> leaves;
-    leaves.resize(m_nodeCount);
-    int32 count = 0;
+    FrameArray<int> stack(FrameArena::Get());
+    FrameArray<int> insideStack(FrameArena::Get());
+    stack.push_back(wideRoot);
 
-    // Collect all leaves
-    for (int32 i = 0; i < m_nodeCapacity; ++i)
+    while (!stack.empty())
     {
-      // Already in the free list
-      if (m_nodes[i].parent == i)
-      {
-        continue;
-      }
+      const AABBNode4& node = m_wideNodes[stack.back()];
+      stack.pop_back();
 
-      // Clean the leaf
-      if (m_nodes[i].IsLeaf())
-      {
-        m_nodes[i].parent = nullNode;
+      int outsideMask       = 0;
+      int intersectMask     = 0;
+      WideNodeIntersection(vol, node, outsideMask, intersectMask);
 
-        leaves[count++]   = i;
-      }
-      else
+      for (int lane = 0; lane < 4; lane++)
       {
-        // Free the internal node
-        FreeNode(i);
+        int child = node.children[lane];
+        if (child == nullNode || (outsideMask & (1 << lane)) || !SubtreeMayPass(node.categories[lane], includeMask))
+        {
+          continue;
+        }
+
+        if (child < nullNode)
+        {
+          if ((node.categories[lane] & excludeMask) != 0)
+          {
+            continue;
+          }
+
+          if (EntityPtr ntt = m_nodes[DecodeWideLeaf(child)].entity.lock())
+          {
+            result.push_back(ntt.get());
+          }
+        }
+        else if (intersectMask & (1 << lane))
+        {
+          // Volume is partially inside, check all internal volumes.
+          stack.push_back(child);
+        }
+        else
+        {
+          // Volume is fully inside, collect all leaves of the subtree without testing.
+          CollectWideLeaves(child, includeMask, excludeMask, result, insideStack);
+        }
       }
     }
+  }
 
-    while (count > 1)
+  void AABBTree::CollectWideLeaves(int wideNode,
+                                   uint includeMask,
+                                   uint excludeMask,
+                                   EntityRawPtrArray& result,
+                                   FrameArray<int>& stack) const
+  {
+    stack.push_back(wideNode);
+    while (!stack.empty())
     {
-      float minCost = TK_FLT_MAX;
-      int32 minI    = -1;
-      int32 minJ    = -1;
+      const AABBNode4& node = m_wideNodes[stack.back()];
+      stack.pop_back();
 
-      // Find the best aabb pair
-      for (int32 i = 0; i < count; ++i)
+      for (int lane = 0; lane < 4; lane++)
       {
-        BoundingBox aabbI = m_nodes[leaves[i]].aabb;
-
-        for (int32 j = i + 1; j < count; ++j)
+        int child = node.children[lane];
+        if (child == nullNode || !SubtreeMayPass(node.categories[lane], includeMask))
         {
-          BoundingBox aabbJ    = m_nodes[leaves[j]].aabb;
+          continue;
+        }
 
-          BoundingBox combined = BoundingBox::Union(aabbI, aabbJ);
-          float cost           = combined.SurfaceArea();
+        if (child < nullNode)
+        {
+          if ((node.categories[lane] & excludeMask) != 0)
+          {
+            continue;
+          }
 
-          if (cost < minCost)
+          if (EntityPtr ntt = m_nodes[DecodeWideLeaf(child)].entity.lock())
           {
-            minCost = cost;
-            minI    = i;
-            minJ    = j;
+            result.push_back(ntt.get());
           }
         }
+        else
+        {
+          stack.push_back(child);
+        }
       }
+    }
+  }
 
-      AABBNodeProxy index1      = leaves[minI];
-      AABBNodeProxy index2      = leaves[minJ];
-      AABBNode* child1          = &m_nodes[index1];
-      AABBNode* child2          = &m_nodes[index2];
-
-      // Create a parent(internal) node
-      AABBNodeProxy parentIndex = AllocateNode();
-      AABBNode* parent          = &m_nodes[parentIndex];
-
-      parent->child1            = index1;
-      parent->child2            = index2;
-      parent->aabb              = BoundingBox::Union(child1->aabb, child2->aabb);
-      parent->parent            = nullNode;
+  void AABBTree::MultiFrustumQuery(const FrustumArray& frustums,
+                                   EntityRawPtrArray& entities,
+                                   std::vector<uint64>& masks,
+                                   uint includeMask,
+                                   uint excludeMask)
+  {
+    entities.clear();
+    masks.clear();
 
-      child1->parent            = parentIndex;
-      child2->parent            = parentIndex;
+    assert(frustums.size() <= maxQueryFrustums && "Too many frustums for a single query.");
+    const int frustumCount = glm::min((int) frustums.size(), maxQueryFrustums);
 
-      leaves[minI]              = parentIndex;
+    UpdateTree();
 
-      leaves[minJ]              = leaves[count - 1];
-      --count;
+    if (m_root == nullNode || frustumCount == 0)
+    {
+      return;
     }
 
-    if (!leaves.empty())
+    if (m_wideTreeDirty)
     {
-      m_root = leaves[0];
-      leaves.clear();
+      BuildWideTree();
     }
-  }
-
-  const BoundingBox& AABBTree::GetRootBoundingBox()
-  {
-    UpdateTree();
 
-    if (m_root != nullNode)
+    // Each item carries the frustums that the wide node is visible from and the ones that fully contain it.
+    // Only the visible frustums that do not fully contain the node are tested against its children.
+    struct QueryItem
     {
-      return m_nodes[m_root].aabb;
-    }
+      int wideNode;
+      uint64 visibleMask;
+      uint64 insideMask;
+    };
 
-    return infinitesimalBox;
-  }
+    FrameArray<QueryItem> stack(FrameArena::Get());
+    FrameArray<int> insideStack(FrameArena::Get());
 
-  AABBNodeProxy AABBTree::AllocateNode()
-  {
-    if (m_freeList == nullNode)
+    const uint64 allFrustums = frustumCount == 64 ? ~0ull : (1ull << frustumCount) - 1ull;
+    stack.push_back({0, allFrustums, 0ull});
+
+    while (!stack.empty())
     {
-      assert(m_nodeCount == m_nodeCapacity);
+      QueryItem item = stack.back();
+      stack.pop_back();
 
-      // Grow the node pool
-      m_nodeCapacity += m_nodeCapacity / 2;
-      m_nodes.resize(m_nodeCapacity);
+      const AABBNode4& node = m_wideNodes[item.wideNode];
 
-      // Build a linked list for the free list.
-      for (int32 i = m_nodeCount; i < m_nodeCapacity - 1; ++i)
+      uint64 laneVisible[4] = {item.visibleMask, item.visibleMask, item.visibleMask, item.visibleMask};
+      uint64 laneInside[4]  = {item.insideMask, item.insideMask, item.insideMask, item.insideMask};
+
+      const uint64 testMask = item.visibleMask & ~item.insideMask;
+      for (int i = 0; i < frustumCount; i++)
       {
-        m_nodes[i].next   = i + 1;
-        m_nodes[i].parent = i;
+        const uint64 frustumBit = 1ull << i;
+        if ((testMask & frustumBit) == 0)
+        {
+          continue;
+        }
+
+        int outsideMask   = 0;
+        int intersectMask = 0;
+        FrustumBox4Intersection(frustums[i], node, outsideMask, intersectMask);
+
+        for (int lane = 0; lane < 4; lane++)
+        {
+          if (outsideMask & (1 << lane))
+          {
+            laneVisible[lane] &= ~frustumBit;
+          }
+          else if ((intersectMask & (1 << lane)) == 0)
+          {
+            laneInside[lane] |= frustumBit;
+          }
+        }
       }
-      m_nodes[m_nodeCapacity - 1].parent = m_nodeCapacity - 1;
-      m_nodes[m_nodeCapacity - 1].next   = nullNode;
 
-      m_freeList                         = m_nodeCount;
-    }
+      for (int lane = 0; lane < 4; lane++)
+      {
+        int child = node.children[lane];
+        if (child == nullNode || laneVisible[lane] == 0 || !SubtreeMayPass(node.categories[lane], includeMask))
+        {
+          continue;
+        }
 
-    AABBNodeProxy node   = m_freeList;
-    m_freeList           = m_nodes[node].next;
-    m_nodes[node].parent = nullNode;
-    m_nodes[node].child1 = nullNode;
-    m_nodes[node].child2 = nullNode;
-    m_nodes[node].entity.reset();
-    m_nodes[node].leafs.clear();
-    ++m_nodeCount;
+        if (child < nullNode)
+        {
+          if ((node.categories[lane] & excludeMask) != 0)
+          {
+            continue;
+          }
 
-    return node;
+          if (EntityPtr ntt = m_nodes[DecodeWideLeaf(child)].entity.lock())
+          {
+            entities.push_back(ntt.get());
+            masks.push_back(laneVisible[lane]);
+          }
+        }
+        else if (laneVisible[lane] == laneInside[lane])
+        {
+          // Fully inside of all the frustums it is visible from, collect all leaves of the subtree without testing.
+          CollectWideLeaves(child, laneVisible[lane], includeMask, excludeMask, entities, masks, insideStack);
+        }
+        else
+        {
+          stack.push_back({child, laneVisible[lane], laneInside[lane]});
+        }
+      }
+    }
   }
 
-  /** Test tree against a frustum. */
-  template TK_API EntityRawPtrArray AABBTree::VolumeQuery(const Frustum& frustum, bool threaded);
-
-  /** Test tree against a box. */
-  template TK_API EntityRawPtrArray AABBTree::VolumeQuery(const BoundingBox& box, bool threaded);
+  void AABBTree::CollectWideLeaves(int wideNode,
+                                   uint64 mask,
+                                   uint includeMask,
+                                   uint excludeMask,
+                                   EntityRawPtrArray& entities,
+                                   std::vector<uint64>& masks,
+                                   FrameArray<int>& stack) const
+  {
+    CollectWideLeaves(wideNode, includeMask, excludeMask, entities, stack);
+    masks.resize(entities.size(), mask);
+  }
 
-  template <typename VolumeType>
-  EntityRawPtrArray AABBTree::VolumeQuery(const VolumeType& vol, bool threaded)
+  EntityPtr AABBTree::RayQuery(const Ray& ray,
+                               bool deep,
+                               float* t,
+                               const IDArray& ignoreList,
+                               uint includeMask,
+                               uint excludeMask)
   {
+    if (m_root == nullNode)
+    {
+      return nullptr;
+    }
+
     UpdateTree();
 
-    EntityRawPtrArray entities;
-    if (m_root == nullNode)
+    RayHit hit;
+    RayStackItemArray stack(FrameArena::Get());
+    TraceRay(ray, deep, false, includeMask, excludeMask, ignoreList, stack, hit);
+
+    if (t != nullptr)
     {
-      return entities;
+      *t = hit.distance;
     }
 
-    EntityRawPtrArray entitiesInVolume;
-    entitiesInVolume.resize(m_nodeCapacity);
-    std::fill(entitiesInVolume.begin(), entitiesInVolume.end(), nullptr);
+    return hit.entity;
+  }
 
-    m_maxThreadCount =
-        m_nodeCount > m_threadTreshold && threaded ? GetWorkerManager()->GetThreadCount(WorkerManager::FramePool) : 0;
+  void AABBTree::RayQueryBatch(const RayArray& rays,
+                               bool deep,
+                               bool anyHit,
+                               RayHitArray& hits,
+                               uint includeMask,
+                               uint excludeMask)
+  {
+    hits.clear();
+    hits.resize(rays.size());
 
-    std::atomic_int availableThreadCount(glm::max(0, m_maxThreadCount - 1));
+    UpdateTree();
 
-    if constexpr (std::is_same_v<VolumeType, Frustum>)
+    if (m_root == nullNode || rays.empty())
     {
-      VolumeQuery(entitiesInVolume,
-                  availableThreadCount,
-                  m_root,
-                  [this, &vol](AABBNodeProxy root) -> IntersectResult
-                  { return FrustumBoxIntersection(vol, m_nodes[root].aabb); });
+      return;
     }
-    else if constexpr (std::is_same_v<VolumeType, BoundingBox>)
+
+    // Sort the rays by their direction octant and then by the morton code of their origin. Coherent rays traced
+    // together visit the same nodes.
+    struct RayOrder
     {
-      VolumeQuery(entitiesInVolume,
-                  availableThreadCount,
-                  m_root,
-                  [this, &vol](AABBNodeProxy root) -> IntersectResult
-                  { return BoxBoxIntersection(vol, m_nodes[root].aabb); });
-    }
-    else
+      uint64 key;
+      int ray;
+    };
+
+    BoundingBox originBox;
+    for (const Ray& ray : rays)
     {
-      assert(0 && "Volume query is not implemented.");
-      return entities;
+      originBox.UpdateBoundary(ray.position);
     }
 
-    // If there are threads in work, wait for them.
-    HyperThreadSpinWait(availableThreadCount.load() < m_maxThreadCount);
+    const Vec3 originExtent = glm::max(originBox.max - originBox.min, Vec3(TK_FLT_MIN));
 
-    entities.reserve(m_nodeCapacity);
+    // Spreads the lower 10 bits of the value to every third bit.
+    auto spreadBitsFn       = [](uint64 v) -> uint64
+    {
+      v = (v | (v << 16)) & 0x030000FFull;
+      v = (v | (v << 8)) & 0x0300F00Full;
+      v = (v | (v << 4)) & 0x030C30C3ull;
+      v = (v | (v << 2)) & 0x09249249ull;
+      return v;
+    };
 
-    for (int i = 0; i < (int) entitiesInVolume.size(); i++)
+    FrameArray<RayOrder> order(rays.size(), FrameArena::Get());
+    for (size_t i = 0; i < rays.size(); i++)
     {
-      if (entitiesInVolume[i] != nullptr)
-      {
-        entities.push_back(entitiesInVolume[i]);
-      }
+      const Ray& ray = rays[i];
+      Vec3 cell      = glm::clamp((ray.position - originBox.min) / originExtent, 0.0f, 1.0f) * 1023.0f;
+
+      uint64 octant  = (ray.direction.x < 0.0f ? 1ull : 0ull) | (ray.direction.y < 0.0f ? 2ull : 0ull) |
+                      (ray.direction.z < 0.0f ? 4ull : 0ull);
+
+      uint64 morton  = spreadBitsFn((uint64) cell.x) | spreadBitsFn((uint64) cell.y) << 1 |
+                      spreadBitsFn((uint64) cell.z) << 2;
+
+      order[i]       = {octant << 30 | morton, (int) i};
     }
 
-    return entities;
+    std::sort(order.begin(), order.end(), [](const RayOrder& a, const RayOrder& b) -> bool { return a.key < b.key; });
+
+    // Trace the rays in chunks, each chunk reuses its traversal stack.
+    const size_t chunkSize  = 64;
+    const size_t chunkCount = (rays.size() + chunkSize - 1) / chunkSize;
+
+    using poolstl::iota_iter;
+    std::for_each(TKExecByConditional(chunkCount > 1, WorkerManager::FramePool),
+                  iota_iter<size_t>(0),
+                  iota_iter<size_t>(chunkCount),
+                  [&](size_t chunk) -> void
+                  {
+                    // Mesh tests may issue parallel loops, run them on this thread.
+                    ParallelTaskScope taskScope;
+
+                    RayStackItemArray stack(FrameArena::Get());
+                    size_t end = std::min((chunk + 1) * chunkSize, rays.size());
+                    for (size_t i = chunk * chunkSize; i < end; i++)
+                    {
+                      int rayIndex = order[i].ray;
+                      TraceRay(rays[rayIndex], deep, anyHit, includeMask, excludeMask, {}, stack, hits[rayIndex]);
+                    }
+                  });
   }
 
-  EntityPtr AABBTree::RayQuery(const Ray& ray, bool deep, float* t, const IDArray& ignoreList)
+  void AABBTree::TraceRay(const Ray& ray,
+                          bool deep,
+                          bool anyHit,
+                          uint includeMask,
+                          uint excludeMask,
+                          const IDArray& ignoreList,
+                          RayStackItemArray& stack,
+                          RayHit& hit)
   {
-    if (m_root == nullNode)
+    hit = RayHit();
+    stack.clear();
+
+    float bestDist         = TK_FLT_MAX;
+    AABBNodeProxy bestLeaf = nullNode;
+
+    // Tests the node's box, nodes that can not contain a nearer hit are rejected.
+    auto testNodeFn        = [&](AABBNodeProxy proxy, float& dist) -> bool
     {
-      return nullptr;
-    }
+      const AABBNode& node = m_nodes[proxy];
+      if (!SubtreeMayPass(node.categories, includeMask))
+      {
+        return false;
+      }
 
-    UpdateTree();
+      if (node.IsLeaf())
+      {
+        // Leaves are tested with the exact entity box for accurate hit distances.
+        return (node.categories & excludeMask) == 0 && RayBoxIntersection(ray, node.entityAabb, dist) &&
+               dist < bestDist;
+      }
 
-    std::deque<AABBNodeProxy> stack;
-    stack.emplace_back(m_root);
+      return RayBoxIntersection(ray, node.aabb, dist) && dist < bestDist;
+    };
 
-    float hitDist = TK_FLT_MAX;
-    EntityPtr hitEntity;
+    float rootDist;
+    if (testNodeFn(m_root, rootDist))
+    {
+      stack.push_back({m_root, rootDist});
+    }
 
-    while (stack.size() != 0)
+    while (!stack.empty())
     {
-      AABBNodeProxy current = stack.back();
+      RayStackItem item = stack.back();
       stack.pop_back();
 
-      float intersecLen;
-      if (RayBoxIntersection(ray, m_nodes[current].aabb, intersecLen))
+      // A nearer hit may be found after the node is pushed.
+      if (item.dist >= bestDist)
+      {
+        continue;
+      }
+
+      const AABBNode& node = m_nodes[item.node];
+      if (node.IsLeaf())
       {
-        if (m_nodes[current].IsLeaf())
+        float hitDist = item.dist;
+        uint submesh  = TK_UINT_MAX;
+
+        if (deep || !ignoreList.empty())
         {
-          EntityPtr candidate = m_nodes[current].entity.lock();
-          if (!ignoreList.empty())
+          EntityPtr ntt = node.entity.lock();
+          if (ntt == nullptr || contains(ignoreList, ntt->GetIdVal()))
           {
-            if (contains(ignoreList, candidate->GetIdVal()))
-            {
-              continue;
-            }
+            continue;
           }
 
           if (deep)
           {
-            float meshDist;
-            if (RayEntityIntersection(ray, candidate, meshDist))
+            if (ntt->GetComponentFast<SkeletonComponent>() != nullptr)
             {
-              intersecLen = meshDist;
+              // Skinned meshes are posed for the test.
+              std::lock_guard<std::mutex> lock(m_skinnedRayTestLock);
+              submesh = FindMeshIntersection(ntt, ray, hitDist);
             }
             else
             {
-              intersecLen = TK_FLT_MAX;
+              submesh = FindMeshIntersection(ntt, ray, hitDist);
+            }
+
+            if (submesh == TK_UINT_MAX)
+            {
+              continue;
             }
           }
+        }
 
-          if (intersecLen < hitDist)
+        if (hitDist < bestDist)
+        {
+          bestDist    = hitDist;
+          bestLeaf    = item.node;
+          hit.submesh = submesh;
+
+          if (anyHit)
           {
-            hitDist   = intersecLen;
-            hitEntity = candidate;
+            break;
           }
         }
+
+        continue;
+      }
+
+      // Push the farther child first to visit the nearer one first.
+      float dist1, dist2;
+      bool hit1 = testNodeFn(node.child1, dist1);
+      bool hit2 = testNodeFn(node.child2, dist2);
+
+      if (hit1 && hit2)
+      {
+        if (dist1 < dist2)
+        {
+          stack.push_back({node.child2, dist2});
+          stack.push_back({node.child1, dist1});
+        }
         else
         {
-          stack.emplace_back(m_nodes[current].child1);
-          stack.emplace_back(m_nodes[current].child2);
+          stack.push_back({node.child1, dist1});
+          stack.push_back({node.child2, dist2});
         }
       }
+      else if (hit1)
+      {
+        stack.push_back({node.child1, dist1});
+      }
+      else if (hit2)
+      {
+        stack.push_back({node.child2, dist2});
+      }
     }
 
-    if (t != nullptr)
+    hit.distance = bestDist;
+    if (bestLeaf != nullNode)
     {
-      *t = hitDist;
+      hit.entity = m_nodes[bestLeaf].entity.lock();
     }
-
-    return hitEntity;
   }
 
   void AABBTree::GetDebugBoundingBoxes(EntityPtrArray& boundingBoxes)
@@ -430,7 +1604,6 @@ namespace ToolKit
     m_nodes[node].parent = node;
     m_nodes[node].next   = m_freeList;
     m_nodes[node].entity.reset();
-    m_nodes[node].leafs.clear();
     m_freeList = node;
 
     --m_nodeCount;
@@ -481,32 +1654,12 @@ namespace ToolKit
       return;
     }
 
-    // n0 does not invalidate its parent leaf cache, n1 does due to depth difference.
-    // n0 is at a lower depth, moving it a higher depth does not alter n's leafs.
-    auto leafCacheUpdate = [&](AABBNodeProxy n0, AABBNodeProxy n1) -> void
-    {
-      AABBNodeProxy n0sibling = m_nodes[n1].parent;
-      assert(n0sibling != nullNode);
-
-      for (AABBNodeProxy leaf : m_nodes[n1].leafs)
-      {
-        m_nodes[n0sibling].leafs.erase(leaf);
-      }
-
-      for (AABBNodeProxy leaf : m_nodes[n0].leafs)
-      {
-        m_nodes[n0sibling].leafs.insert(leaf);
-      }
-    };
-
     // printf("Tree rotation occurred: %d\n", bestDiffIndex);
     switch (bestDiffIndex)
     {
     case 0:
     {
       // Swap(child2, nodes[child1].child2);
-      leafCacheUpdate(child2, m_nodes[child1].child2);
-
       m_nodes[m_nodes[child1].child2].parent = node;
       m_nodes[node].child2                   = m_nodes[child1].child2;
 
@@ -515,13 +1668,12 @@ namespace ToolKit
 
       m_nodes[child1].aabb =
           BoundingBox::Union(m_nodes[m_nodes[child1].child1].aabb, m_nodes[m_nodes[child1].child2].aabb);
+      m_nodes[child1].categories = ChildCategories(child1);
     }
     break;
     case 1:
     {
       // Swap(child2, nodes[child1].child1);
-      leafCacheUpdate(child2, m_nodes[child1].child1);
-
       m_nodes[m_nodes[child1].child1].parent = node;
       m_nodes[node].child2                   = m_nodes[child1].child1;
 
@@ -530,13 +1682,12 @@ namespace ToolKit
 
       m_nodes[child1].aabb =
           BoundingBox::Union(m_nodes[m_nodes[child1].child1].aabb, m_nodes[m_nodes[child1].child2].aabb);
+      m_nodes[child1].categories = ChildCategories(child1);
     }
     break;
     case 2:
     {
       // Swap(child1, nodes[child2].child2);
-      leafCacheUpdate(child1, m_nodes[child2].child2);
-
       m_nodes[m_nodes[child2].child2].parent = node;
       m_nodes[node].child1                   = m_nodes[child2].child2;
 
@@ -544,13 +1695,12 @@ namespace ToolKit
       m_nodes[child1].parent                 = child2;
       m_nodes[child2].aabb =
           BoundingBox::Union(m_nodes[m_nodes[child2].child1].aabb, m_nodes[m_nodes[child2].child2].aabb);
+      m_nodes[child2].categories = ChildCategories(child2);
     }
     break;
     case 3:
     {
       // Swap(child1, nodes[child2].child1);
-      leafCacheUpdate(child1, m_nodes[child2].child1);
-
       m_nodes[m_nodes[child2].child1].parent = node;
       m_nodes[node].child1                   = m_nodes[child2].child1;
 
@@ -559,85 +1709,19 @@ namespace ToolKit
 
       m_nodes[child2].aabb =
           BoundingBox::Union(m_nodes[m_nodes[child2].child1].aabb, m_nodes[m_nodes[child2].child2].aabb);
+      m_nodes[child2].categories = ChildCategories(child2);
     }
     break;
     }
   }
 
-  void AABBTree::VolumeQuery(EntityRawPtrArray& result,
-                             std::atomic_int& threadCount,
-                             AABBNodeProxy root,
-                             std::function<IntersectResult(AABBNodeProxy)> queryFn) const
-  {
-    std::deque<AABBNodeProxy> stack;
-    stack.emplace_back(root);
-
-    while (stack.size() != 0)
-    {
-      AABBNodeProxy current = stack.back();
-      stack.pop_back();
-
-      IntersectResult intResult = queryFn(current);
-
-      if (intResult == IntersectResult::Intersect)
-      {
-        // Volume is partially inside, check all internal volumes.
-        if (m_nodes[current].IsLeaf())
-        {
-          if (!m_nodes[current].entity.expired())
-          {
-            result[current] = m_nodes[current].entity.lock().get();
-          }
-        }
-        else
-        {
-          auto parallelProcessFn = [&](AABBNodeProxy node) -> void
-          {
-            if (node == nullNode)
-            {
-              return;
-            }
-
-            int currentCount = threadCount.load();
-            if (currentCount > 0)
-            {
-              if (threadCount.compare_exchange_strong(currentCount, currentCount - 1))
-              {
-                TKAsyncTask(WorkerManager::FramePool,
-                            [this, &result, &threadCount, node, queryFn]() -> void
-                            { VolumeQuery(result, threadCount, node, queryFn); });
-                return;
-              }
-            }
-
-            stack.emplace_back(node);
-          };
-
-          parallelProcessFn(m_nodes[current].child1);
-          parallelProcessFn(m_nodes[current].child2);
-        }
-      }
-      else if (intResult == IntersectResult::Inside)
-      {
-        // Volume is fully inside, get all entities from cache.
-        for (AABBNodeProxy leaf : m_nodes[current].leafs)
-        {
-          if (!m_nodes[leaf].entity.expired())
-          {
-            result[leaf] = m_nodes[leaf].entity.lock().get();
-          }
-        }
-      }
-    }
-
-    threadCount.fetch_add(1);
-  }
-
   AABBNodeProxy AABBTree::InsertLeaf(AABBNodeProxy leaf)
   {
     assert(0 <= leaf && leaf < m_nodeCapacity);
     assert(m_nodes[leaf].IsLeaf());
 
+    m_wideTreeDirty = true;
+
     if (m_root == nullNode)
     {
       m_root = leaf;
@@ -693,16 +1777,17 @@ namespace ToolKit
     }
 
     // Create a new parent
-    AABBNodeProxy oldParent     = m_nodes[bestSibling].parent;
-    AABBNodeProxy newParent     = AllocateNode();
-    m_nodes[newParent].aabb     = BoundingBox::Union(aabb, m_nodes[bestSibling].aabb);
-    m_nodes[newParent].parent   = oldParent;
+    AABBNodeProxy oldParent       = m_nodes[bestSibling].parent;
+    AABBNodeProxy newParent       = AllocateNode();
+    m_nodes[newParent].aabb       = BoundingBox::Union(aabb, m_nodes[bestSibling].aabb);
+    m_nodes[newParent].categories = m_nodes[leaf].categories | m_nodes[bestSibling].categories;
+    m_nodes[newParent].parent     = oldParent;
 
     // Connect new leaf and sibling to new parent
-    m_nodes[newParent].child1   = leaf;
-    m_nodes[newParent].child2   = bestSibling;
-    m_nodes[leaf].parent        = newParent;
-    m_nodes[bestSibling].parent = newParent;
+    m_nodes[newParent].child1     = leaf;
+    m_nodes[newParent].child2     = bestSibling;
+    m_nodes[leaf].parent          = newParent;
+    m_nodes[bestSibling].parent   = newParent;
 
     if (oldParent != nullNode)
     {
@@ -720,29 +1805,15 @@ namespace ToolKit
       m_root = newParent;
     }
 
-    // Construct new parent's leaf cache.
-    if (m_nodes[bestSibling].IsLeaf())
-    {
-      m_nodes[newParent].leafs.insert(bestSibling);
-    }
-    else
-    {
-      for (AABBNodeProxy sibLeaf : m_nodes[bestSibling].leafs)
-      {
-        m_nodes[newParent].leafs.insert(sibLeaf);
-      }
-    }
-
     // Walk back up the tree refitting ancestors' AABB and applying rotations
     AABBNodeProxy ancestor = newParent;
     while (ancestor != nullNode)
     {
-      m_nodes[ancestor].leafs.insert(leaf); // Insert to all ancestors.
+      AABBNodeProxy child1         = m_nodes[ancestor].child1;
+      AABBNodeProxy child2         = m_nodes[ancestor].child2;
 
-      AABBNodeProxy child1   = m_nodes[ancestor].child1;
-      AABBNodeProxy child2   = m_nodes[ancestor].child2;
-
-      m_nodes[ancestor].aabb = BoundingBox::Union(m_nodes[child1].aabb, m_nodes[child2].aabb);
+      m_nodes[ancestor].aabb       = BoundingBox::Union(m_nodes[child1].aabb, m_nodes[child2].aabb);
+      m_nodes[ancestor].categories = m_nodes[child1].categories | m_nodes[child2].categories;
 
       Rotate(ancestor);
 
@@ -757,8 +1828,9 @@ namespace ToolKit
     assert(0 <= leaf && leaf < m_nodeCapacity);
     assert(m_nodes[leaf].IsLeaf());
 
-    // Remove the leaf if its in invalid nodes.
-    m_invalidNodes.erase(leaf);
+    // Remove the leaf from invalid nodes. The entry in the array is skipped during the update.
+    m_nodes[leaf].invalid = false;
+    m_wideTreeDirty       = true;
 
     AABBNodeProxy parent = m_nodes[leaf].parent;
     if (parent == nullNode) // node is root
@@ -797,12 +1869,11 @@ namespace ToolKit
       AABBNodeProxy ancestor = grandParent;
       while (ancestor != nullNode)
       {
-        m_nodes[ancestor].leafs.erase(leaf); // Remove from all ancestors.
-
-        AABBNodeProxy child1   = m_nodes[ancestor].child1;
-        AABBNodeProxy child2   = m_nodes[ancestor].child2;
+        AABBNodeProxy child1         = m_nodes[ancestor].child1;
+        AABBNodeProxy child2         = m_nodes[ancestor].child2;
 
-        m_nodes[ancestor].aabb = BoundingBox::Union(m_nodes[child1].aabb, m_nodes[child2].aabb);
+        m_nodes[ancestor].aabb       = BoundingBox::Union(m_nodes[child1].aabb, m_nodes[child2].aabb);
+        m_nodes[ancestor].categories = m_nodes[child1].categories | m_nodes[child2].categories;
 
         Rotate(ancestor);
 
@@ -14,25 +14,47 @@
 
 #pragma once
 
+#include "FrameArena.h"
 #include "GeometryTypes.h"
 
 namespace ToolKit
 {
 
   typedef int AABBNodeProxy;
-  typedef std::unordered_set<AABBNodeProxy> AABBNodeProxySet;
   typedef std::vector<AABBNodeProxy> NodeProxyArray;
 
   class TK_API AABBTree
   {
    public:
-    static constexpr inline int32 nullNode = -1;
+    static constexpr inline int32 nullNode       = -1;
+
+    /** Maximum number of frustums that can be tested in a single multi frustum query. */
+    static constexpr inline int maxQueryFrustums = 64;
+
+    /**
+     * Category bits of the entities in the tree. Internal nodes carry the union of their leaves' categories, so that
+     * queries can skip the subtrees that do not contain any entity of the requested categories.
+     */
+    enum Category : uint
+    {
+      CategoryNone         = 0,
+      CategoryShadowCaster = 1 << 0, //!< Has a mesh component that casts shadow.
+      CategoryLight        = 1 << 1, //!< Light entities.
+      CategoryVisible      = 1 << 2, //!< Entity's own visibility is on.
+      CategoryMesh         = 1 << 3, //!< Has a mesh component.
+      CategoryUI           = 1 << 4, //!< Surfaces and other ui entities.
+      CategoryEditorOnly   = 1 << 5  //!< Billboards, which are only used as editor helpers.
+    };
 
     struct AABBNode
     {
       bool IsLeaf() const { return child1 == nullNode; }
 
+      /** Enlarged by the leaf margin for leaves, so that small moves of the entity do not alter the tree. */
       BoundingBox aabb;
+
+      /** Exact bounding box of the entity. Only valid for leaves and used for testing leaves in the queries. */
+      BoundingBox entityAabb;
       EntityWeakPtr entity;
 
       AABBNodeProxy parent;
@@ -40,11 +62,55 @@ namespace ToolKit
       AABBNodeProxy child2;
       AABBNodeProxy next;
 
-      AABBNodeProxySet leafs;
+      /** Category bits of the leaf's entity, or union of the leaves' categories for internal nodes. */
+      uint categories = CategoryNone;
+
+      /** True if the leaf is in the invalid nodes waiting for update. */
+      bool invalid    = false;
+
+      /** Wide node index * 4 + lane that the node is stored in. nullNode if the node is opened while collapsing. */
+      int wideLane    = nullNode;
     };
 
     typedef std::vector<AABBNode> AABBNodeArray;
-    typedef std::set<AABBNodeProxy> AABBNodeSet;
+
+    /**
+     * Node of the four wide tree that is collapsed from the binary tree for fast volume queries.
+     * Child bounds are stored in structure of arrays layout to test all four of them at once with SIMD.
+     */
+    struct alignas(16) AABBNode4
+    {
+      float minX[4];
+      float minY[4];
+      float minZ[4];
+      float maxX[4];
+      float maxY[4];
+      float maxZ[4];
+
+      /** Wide node index if positive, encoded leaf proxy if less than nullNode, nullNode for empty lanes. */
+      int children[4];
+
+      /** Categories of the children. */
+      uint categories[4];
+    };
+
+    typedef std::vector<AABBNode4> AABBNode4Array;
+
+    /** Result of a ray in batched ray queries. */
+    struct RayHit
+    {
+      EntityPtr entity = nullptr;     //!< Hit entity. Null if the ray does not hit anything.
+      float distance   = TK_FLT_MAX;  //!< Distance to the hit along the ray.
+      uint submesh     = TK_UINT_MAX; //!< Index of the hit submesh for deep queries.
+    };
+
+    typedef std::vector<RayHit> RayHitArray;
+
+    /** Encodes a leaf proxy to be stored as a wide node child. */
+    static constexpr int EncodeWideLeaf(AABBNodeProxy leaf) { return -leaf - 2; }
+
+    /** Decodes the leaf proxy from a wide node child. */
+    static constexpr AABBNodeProxy DecodeWideLeaf(int child) { return -child - 2; }
 
    public:
     AABBTree();
@@ -56,7 +122,11 @@ namespace ToolKit
     void Reset();
     AABBNodeProxy CreateNode(EntityWeakPtr entity, const BoundingBox& aabb);
 
-    /** Updates the aabb tree for every invalid node, if any. */
+    /**
+     * Updates the aabb tree for every invalid node, if any. Leaves that are still inside of their enlarged boxes are
+     * left in place. Leaves that moved out are reinserted, or if too many of them moved, their boxes are enlarged in
+     * place and the whole tree is refit in parallel.
+     */
     void UpdateTree();
 
     /** Invalidates the given node. */
@@ -65,10 +135,22 @@ namespace ToolKit
     /** Removes given node from aabb tree. */
     void RemoveNode(AABBNodeProxy node);
 
+    /**
+     * Sets the margin that leaf boxes are enlarged with on each side. Bigger margins avoid more updates for moving
+     * entities at the cost of looser trees. Applies to the leaves that are inserted or updated afterwards.
+     */
+    void SetLeafMargin(float margin);
+
+    /** Returns the margin that leaf boxes are enlarged with on each side. */
+    float GetLeafMargin() const;
+
     /** Calls the callback function for each node in a depth first manner. */
     void Traverse(std::function<void(const AABBNode*)> callback);
 
-    /** Creates an optimum aabb tree in bottom up fashion but its very slow to use even at scene loading.  */
+    /**
+     * Creates an optimum aabb tree in top down fashion using binned surface area heuristic.
+     * Subtrees are built in parallel. Fast enough to call after scene loading or bulk edits.
+     */
     void Rebuild();
 
     /** Return debug boxes for each node in the tree. */
@@ -77,15 +159,89 @@ namespace ToolKit
     /** Returns the bounding box that covers all entities. */
     const BoundingBox& GetRootBoundingBox();
 
-    /** Template for volume queries. VolumeTypes: {Frustum, BoundingBox} */
+    /**
+     * Template for volume queries. VolumeTypes: {Frustum, BoundingBox}
+     * @param includeMask Only the entities that have any of these categories are returned. Zero includes all.
+     * @param excludeMask Entities that have any of these categories are not returned.
+     */
     template <typename VolumeType>
-    EntityRawPtrArray VolumeQuery(const VolumeType& vol, bool threaded = false);
+    EntityRawPtrArray VolumeQuery(const VolumeType& vol,
+                                  bool threaded    = false,
+                                  uint includeMask = CategoryNone,
+                                  uint excludeMask = CategoryNone);
+
+    /**
+     * Tests the tree against all the frustums with a single traversal. Each subtree is only tested against the frustums
+     * that it intersects with, subtrees that are fully inside of a frustum are not tested against that frustum again.
+     * @param frustums Frustums to test against. At most maxQueryFrustums.
+     * @param entities Entities that are inside or intersecting with at least one of the frustums.
+     * @param masks Visibility mask for each entity. Bit i is set if the entity is visible from frustums[i].
+     * @param includeMask Only the entities that have any of these categories are returned. Zero includes all.
+     * @param excludeMask Entities that have any of these categories are not returned.
+     */
+    void MultiFrustumQuery(const FrustumArray& frustums,
+                           EntityRawPtrArray& entities,
+                           std::vector<uint64>& masks,
+                           uint includeMask = CategoryNone,
+                           uint excludeMask = CategoryNone);
 
     /**
      * Test ray against the tree and returns the nearest entity that hits the ray and the hit distance t.
      * If the deep parameter passed as true, it checks mesh level intersection.
+     * Entities can be filtered with category masks same as the volume queries.
      */
-    EntityPtr RayQuery(const Ray& ray, bool deep, float* t = nullptr, const IDArray& ignoreList = {});
+    EntityPtr RayQuery(const Ray& ray,
+                       bool deep,
+                       float* t                  = nullptr,
+                       const IDArray& ignoreList = {},
+                       uint includeMask          = CategoryNone,
+                       uint excludeMask          = CategoryNone);
+
+    /**
+     * Tests all the rays against the tree. Rays are sorted for coherence and traced in parallel on the frame pool.
+     * @param rays Rays to test.
+     * @param deep Checks mesh level intersection and reports the hit submesh, otherwise bounding boxes are hit.
+     * @param anyHit Stops at the first hit instead of searching for the nearest one. Fast for occlusion tests.
+     * @param hits Result for each ray, in the same order with the rays.
+     * @param includeMask Only the entities that have any of these categories are hit. Zero includes all.
+     * @param excludeMask Entities that have any of these categories are not hit.
+     */
+    void RayQueryBatch(const RayArray& rays,
+                       bool deep,
+                       bool anyHit,
+                       RayHitArray& hits,
+                       uint includeMask = CategoryNone,
+                       uint excludeMask = CategoryNone);
+
+   private:
+    /** A leaf to place in the tree during rebuild. */
+    struct BuildLeaf
+    {
+      AABBNodeProxy node; //!< Leaf node.
+      Vec3 center;        //!< Center of the leaf's bounding box.
+    };
+
+    typedef std::vector<BuildLeaf> BuildLeafArray;
+
+    /** A range of leaves that a subtree is built from during rebuild. */
+    struct BuildRange
+    {
+      int begin;            //!< First leaf of the range.
+      int end;              //!< One past the last leaf of the range.
+      int slot;             //!< First pre allocated internal node that the subtree uses.
+      AABBNodeProxy parent; //!< Parent of the subtree root.
+    };
+
+    typedef std::vector<BuildRange> BuildRangeArray;
+
+    /** A node that waits to be visited while tracing a ray. */
+    struct RayStackItem
+    {
+      AABBNodeProxy node; //!< Node to visit.
+      float dist;         //!< Distance to the node's box along the ray.
+    };
+
+    typedef FrameArray<RayStackItem> RayStackItemArray;
 
    private:
     AABBNodeProxy AllocateNode();
@@ -94,17 +250,108 @@ namespace ToolKit
     void RemoveLeaf(AABBNodeProxy leaf);
     void Rotate(AABBNodeProxy node);
 
-    void VolumeQuery(EntityRawPtrArray& result,
-                     std::atomic_int& threadCount,
-                     AABBNodeProxy root,
-                     std::function<IntersectResult(AABBNodeProxy)> queryFn) const;
+    /** Returns the root node of the subtree that is going to be built from the range. */
+    AABBNodeProxy BuildRangeRoot(const BuildRange& range,
+                                 const BuildLeafArray& leaves,
+                                 const NodeProxyArray& internals) const;
+
+    /**
+     * Builds the subtree for the range. If deferred ranges are provided, ranges smaller than the grain size are not
+     * built but deferred, and internal nodes whose bounding box must be refit after deferred ranges are built are
+     * collected in bottom up order.
+     */
+    void BuildSubtree(const BuildRange& range,
+                      BuildLeafArray& leaves,
+                      const NodeProxyArray& internals,
+                      int grainSize,
+                      BuildRangeArray* deferredRanges,
+                      NodeProxyArray* refitNodes);
+
+    /** Partitions the leaves in the range with binned surface area heuristic and returns the split position. */
+    int SplitBinnedSAH(BuildLeafArray& leaves, int begin, int end) const;
+
+    /** Returns the entity box of the leaf enlarged with the leaf margin. */
+    BoundingBox FattenLeafBox(const BoundingBox& entityAabb) const;
+
+    /**
+     * Traverses the tree front to back and finds the nearest hit of the ray, or any hit if requested. Subtrees that are
+     * farther than the current hit are skipped.
+     */
+    void TraceRay(const Ray& ray,
+                  bool deep,
+                  bool anyHit,
+                  uint includeMask,
+                  uint excludeMask,
+                  const IDArray& ignoreList,
+                  RayStackItemArray& stack,
+                  RayHit& hit);
+
+    /** Returns the union of the categories of the internal node's children. */
+    uint ChildCategories(AABBNodeProxy node) const;
+
+    /** Recalculates bounding boxes of all internal nodes bottom up. Subtrees are refit in parallel. */
+    void RefitTree();
+
+    /** Recalculates bounding boxes of all internal nodes in the subtree bottom up. */
+    void RefitSubtree(AABBNodeProxy subtreeRoot);
+
+    /** Collapses the binary tree into the four wide tree. */
+    void BuildWideTree();
+
+    /**
+     * Copies the bounding box and categories of the node to its lane in the four wide tree. Keeps the wide tree valid
+     * while the binary tree topology does not change. Does nothing if the wide tree is going to be rebuilt.
+     */
+    void UpdateWideLane(AABBNodeProxy node);
+
+    /** Updates all lanes of the four wide tree after the binary tree is refit. */
+    void RefitWideTree();
+
+    /**
+     * Traverses the four wide tree from the given wide node and collects the entities that are inside or intersecting
+     * with the volume and pass the category masks.
+     */
+    template <typename VolumeType>
+    void WideVolumeQuery(const VolumeType& vol,
+                         int wideRoot,
+                         uint includeMask,
+                         uint excludeMask,
+                         EntityRawPtrArray& result) const;
+
+    /** Collects all entities under the wide node that pass the category masks without volume testing. */
+    void CollectWideLeaves(int wideNode,
+                           uint includeMask,
+                           uint excludeMask,
+                           EntityRawPtrArray& result,
+                           FrameArray<int>& stack) const;
+
+    /** Collects all entities under the wide node same as above and assigns the visibility mask to them. */
+    void CollectWideLeaves(int wideNode,
+                           uint64 mask,
+                           uint includeMask,
+                           uint excludeMask,
+                           EntityRawPtrArray& entities,
+                           std::vector<uint64>& masks,
+                           FrameArray<int>& stack) const;
 
    private:
     AABBNodeProxy m_root;
     AABBNodeProxy m_freeList;
 
     AABBNodeArray m_nodes;
-    AABBNodeSet m_invalidNodes;
+
+    /** Leaves that are waiting for update. Leaves are deduplicated with their invalid flag. */
+    NodeProxyArray m_invalidNodes;
+
+    /** Margin that leaf boxes are enlarged with on each side. */
+    float m_leafMargin;
+
+    /**
+     * Four wide tree collapsed from m_nodes. Root is the first node. Lanes are updated in place when boxes change and
+     * the whole tree is lazily rebuilt when the binary tree topology changes.
+     */
+    AABBNode4Array m_wideNodes;
+    bool m_wideTreeDirty;
 
     int m_nodeCapacity;
     int m_nodeCount;
@@ -112,8 +359,8 @@ namespace ToolKit
     /** Threshold node count to do threaded traverse for volume queries. */
     const int m_threadTreshold;
 
-    /** Internally used to get max available thread count. */
-    mutable int m_maxThreadCount;
+    /** Serializes the mesh tests of skinned entities, which pose the skeleton, while rays are traced in parallel. */
+    std::mutex m_skinnedRayTestLock;
   };
 
 } // namespace ToolKit
@@ -15,6 +15,7 @@
 #include "Mesh.h"
 #include "Node.h"
 #include "Skeleton.h"
+#include "Threads.h"
 #include "ToolKit.h"
 #include "Util.h"
 
@@ -23,6 +24,20 @@ static constexpr bool SERIALIZE_ANIMATION_AS_BINARY = false;
 namespace ToolKit
 {
 
+  /**
+   * Largest matrix component that animation data textures are baked in half precision for, which is the largest finite
+   * half value. Translation is stored along with its rounding error, its relative error is within 2^-22 like 32 bit
+   * floats.
+   */
+  static constexpr float HalfPrecisionAnimationRange = 65504.0f;
+
+  /**
+   * Largest distance of a skinned mesh's bind pose from its origin that its animations are baked in half precision
+   * for. Rotation and scale keep the 11 significant bits of half precision, the error of a skinned vertex grows with
+   * its distance to the origin and is within sqrt(3) * 2^-11 of it, about 2 millimeters at this extent in meters.
+   */
+  static constexpr float HalfPrecisionSkinMeshExtent = 2.5f;
+
   TKDefineClass(Animation, Resource);
 
   Animation::Animation() {}
@@ -64,7 +79,7 @@ namespace ToolKit
     node->SetLocalTransforms(positon, rotation, scale);
   }
 
-  void Animation::GetPose(const SkeletonComponentPtr& skeleton, float time)
+  void Animation::GetPose(const SkeletonComponentPtr& skeleton, float time, float weight)
   {
     if (m_keys.empty())
     {
@@ -108,7 +123,13 @@ namespace ToolKit
       orientation                        = glm::slerp(k1.m_rotation, k2.m_rotation, ratio);
       scale                              = Interpolate(k1.m_scale, k2.m_scale, ratio);
 
-      // TODO CPU skinning for blended animations
+      if (weight < 1.0f)
+      {
+        Node* node  = dBone.node;
+        translation = glm::mix(node->GetTranslation(TransformationSpace::TS_LOCAL), translation, weight);
+        orientation = glm::slerp(node->GetOrientation(TransformationSpace::TS_LOCAL), orientation, weight);
+        scale       = glm::mix(node->GetScale(), scale, weight);
+      }
 
       dBone.node->SetLocalTransforms(translation, orientation, scale);
     }
@@ -450,6 +471,19 @@ namespace ToolKit
           {
             skComp->m_animData.currentAnimation = nullptr;
             skComp->m_animData.blendAnimation   = nullptr;
+            skComp->ReleaseBonePalette();
+
+            // Bind pose is drawn once the animation stops, bones and the bounding box follow it.
+            if (skComp->m_map != nullptr)
+            {
+              if (SkeletonPtr skeleton = skComp->GetSkeletonResourceVal())
+              {
+                skComp->m_map->ResetToBindPose(skeleton.get());
+              }
+            }
+
+            skComp->isDirty = true;
+            ntt->InvalidateSpatialCaches();
           }
         }
 
@@ -473,7 +507,15 @@ namespace ToolKit
       UpdateAnimationData();
     }
 
+    bool paletteSkinning = GetEngineSettings().Graphics.useBonePaletteSkinning;
+    if (paletteSkinning)
+    {
+      // Poses are evaluated on the cpu, baked animation textures are not needed.
+      ClearAnimationData();
+    }
+
     // Fill skeleton components with anim data
+    std::vector<SkeletonComponentPtr> posedSkeletons;
     for (auto it = m_records.begin(); it != m_records.end(); it++)
     {
       AnimRecordPtr record = *it;
@@ -495,6 +537,7 @@ namespace ToolKit
           skComp->m_animData.secondKeyFrame            = (float) key2 / skComp->m_animData.keyFrameCount;
           skComp->m_animData.keyFrameInterpolationTime = ratio;
           skComp->m_animData.currentAnimation          = record->m_animation;
+          skComp->m_animData.currentTime               = record->m_currentTime;
 
           AnimRecordPtr recordToBlend                  = record->m_blendingData.recordToBlend;
           if (recordToBlend != nullptr)
@@ -509,14 +552,65 @@ namespace ToolKit
             skComp->m_animData.blendSecondKeyFrame            = (float) key2 / skComp->m_animData.blendKeyFrameCount;
             skComp->m_animData.blendKeyFrameInterpolationTime = ratio;
             skComp->m_animData.blendAnimation                 = recordToBlend->m_animation;
+            skComp->m_animData.blendTime                      = recordToBlend->m_currentTime;
           }
           else
           {
             skComp->m_animData.blendAnimation = nullptr;
           }
+
+          if (!paletteSkinning)
+          {
+            // Bakes the textures if palette skinning is turned off while playing.
+            AddAnimationData(ntt, record->m_animation);
+            skComp->ReleaseBonePalette();
+          }
+
+          // Pose the bones on the cpu for the bounding box, which is fit to the pose with the mesh's bone bounds.
+          bool needsPose  = record->m_state == AnimRecord::State::Play;
+          needsPose      |= paletteSkinning && skComp->m_animData.bonePalette == nullptr;
+          if (needsPose && !contains(posedSkeletons, skComp))
+          {
+            posedSkeletons.push_back(skComp);
+          }
         }
       }
     }
+
+    // Each task only touches the bones of its own skeleton component.
+    using poolstl::iota_iter;
+    std::for_each(TKExecByConditional(posedSkeletons.size() > 1, WorkerManager::FramePool),
+                  iota_iter<size_t>(0),
+                  iota_iter<size_t>(posedSkeletons.size()),
+                  [&](size_t i)
+                  {
+                    const SkeletonComponentPtr& skComp = posedSkeletons[i];
+                    const AnimData& animData           = skComp->m_animData;
+
+                    animData.currentAnimation->GetPose(skComp, animData.currentTime);
+                    if (animData.blendAnimation != nullptr)
+                    {
+                      animData.blendAnimation->GetPose(skComp, animData.blendTime, animData.animationBlendFactor);
+                    }
+
+                    if (paletteSkinning)
+                    {
+                      skComp->UpdateBonePalette();
+                    }
+                  });
+
+    for (const SkeletonComponentPtr& skComp : posedSkeletons)
+    {
+      if (EntityPtr ntt = skComp->OwnerEntity())
+      {
+        ntt->InvalidateSpatialCaches();
+      }
+
+      if (paletteSkinning)
+      {
+        skComp->UploadBonePalette();
+      }
+    }
   }
 
   int AnimationPlayer::Exist(ULongID id) const
@@ -545,20 +639,47 @@ namespace ToolKit
 
   void AnimationPlayer::AddAnimationData(EntityWeakPtr ntt, AnimationPtr anim)
   {
+    if (GetEngineSettings().Graphics.useBonePaletteSkinning)
+    {
+      return;
+    }
+
     if (EntityPtr entity = ntt.lock())
     {
       if (SkeletonComponentPtr skelComp = entity->GetComponent<SkeletonComponent>())
       {
         if (SkeletonPtr skeleton = skelComp->GetSkeletonResourceVal())
         {
-          if (m_animTextures.find(std::make_pair(skeleton->GetIdVal(), anim->GetIdVal())) != m_animTextures.end())
+          // Half precision is used only for the meshes that stay close to their origin, rotation errors grow with the
+          // distance and make the vertices far from it jitter.
+          bool halfPrecision = GetEngineSettings().Graphics.useHalfPrecisionAnimations;
+          if (halfPrecision)
           {
-            // this animation data already exists
-            return;
+            MeshComponentPtr meshComp = entity->GetMeshComponent();
+            MeshPtr mesh              = meshComp != nullptr ? meshComp->GetMeshVal() : nullptr;
+            halfPrecision             = mesh != nullptr && mesh->m_boundingBox.IsValid();
+            if (halfPrecision)
+            {
+              const BoundingBox& box = mesh->m_boundingBox;
+              float extent           = glm::length(glm::max(glm::abs(box.min), glm::abs(box.max)));
+              halfPrecision          = extent <= HalfPrecisionSkinMeshExtent;
+            }
           }
 
-          DataTexturePtr texture = CreateAnimationDataTexture(skeleton, anim);
-          m_animTextures[std::make_pair(skeleton->GetIdVal(), anim->GetIdVal())] = texture;
+          auto key     = std::make_pair(skeleton->GetIdVal(), anim->GetIdVal());
+          auto texture = m_animTextures.find(key);
+          if (texture != m_animTextures.end())
+          {
+            // this animation data already exists. Meshes of the skeleton share it, a half precision texture is baked
+            // again in 32 bit once a mesh that needs it plays the animation.
+            const DataTexturePtr& data = texture->second;
+            if (data == nullptr || halfPrecision || data->Settings().Type != GraphicTypes::TypeHalfFloat)
+            {
+              return;
+            }
+          }
+
+          m_animTextures[key] = CreateAnimationDataTexture(skeleton, anim, halfPrecision);
         }
       }
     }
@@ -604,33 +725,40 @@ namespace ToolKit
 
   void AnimationPlayer::ClearAnimationData() { m_animTextures.clear(); }
 
-  DataTexturePtr AnimationPlayer::CreateAnimationDataTexture(SkeletonPtr skeleton, AnimationPtr anim)
+  DataTexturePtr AnimationPlayer::CreateAnimationDataTexture(SkeletonPtr skeleton,
+                                                             AnimationPtr anim,
+                                                             bool allowHalfPrecision)
   {
     if (anim->m_keys.empty())
     {
       return nullptr;
     }
 
-    uint height        = 1024;                               // max number of key frames
-    uint width         = (int) skeleton->m_bones.size() * 4; // number of bones * 4 (each element holds a row of matrix)
-    uint sizeOfElement = 16 * 4;                             // size of an element in bytes
-
-    char* buffer       = new char[height * width * sizeOfElement];
-
-    uint maxKeyCount   = 0;
-    uint keyframeIndex = 0;
-    while (true)
+    // The texture has a row per key frame, up to the longest track of the skeleton's bones.
+    uint keyCount = 0;
+    for (auto& dBoneIter : skeleton->m_Tpose.m_boneMap)
     {
-      if (keyframeIndex >= height)
+      auto track = anim->m_keys.find(dBoneIter.first);
+      if (track != anim->m_keys.end())
       {
-        TK_ERR("The maximum number of key frames for animations is 1024!");
-        TK_ERR("Animation \"%s\" has more than 1024 key frames.", anim->GetFile().c_str());
-        SafeDelArray(buffer);
-        return nullptr;
+        keyCount = glm::max(keyCount, (uint) track->second.size());
       }
+    }
 
-      bool keysframesLeft = false;
-      std::vector<std::pair<Node*, uint>> boneNodes;
+    if (keyCount == 0)
+    {
+      return nullptr;
+    }
+
+    uint boneCount = (uint) skeleton->m_bones.size();
+    uint width     = boneCount * BoneTransformTexelCount;
+    Vec4Array texels(width * keyCount);
+    float maxComponent = 0.0f;
+
+    std::vector<std::pair<Node*, uint>> boneNodes;
+    for (uint keyframeIndex = 0; keyframeIndex < keyCount; keyframeIndex++)
+    {
+      boneNodes.clear();
 
       // Iterate all bones for the key frame and get node transformations
       for (auto& dBoneIter : skeleton->m_Tpose.m_boneMap)
@@ -638,36 +766,20 @@ namespace ToolKit
         const String& name                 = dBoneIter.first;
         DynamicBoneMap::DynamicBone& dBone = dBoneIter.second;
 
-        if (anim->m_keys.find(name) == anim->m_keys.end())
+        auto track                         = anim->m_keys.find(name);
+        if (track == anim->m_keys.end() || track->second.empty())
         {
           dBone.node->SetLocalTransforms(Vec3(), Quaternion(), Vec3(1.0f));
-          boneNodes.push_back(std::make_pair(dBone.node, dBone.boneIndx));
-          continue;
-        }
-
-        std::vector<Key>& keys = anim->m_keys[name];
-        if (keys.size() <= keyframeIndex)
-        {
-          continue;
         }
         else
         {
-          if (maxKeyCount < keys.size())
-          {
-            maxKeyCount = (uint) keys.size();
-          }
-
-          keysframesLeft = true;
-
-          Key& key       = keys[keyframeIndex];
+          // Shorter tracks hold their last key.
+          KeyArray& keys = track->second;
+          Key& key       = keys[glm::min(keyframeIndex, (uint) keys.size() - 1)];
           dBone.node->SetLocalTransforms(key.m_position, key.m_rotation, key.m_scale);
-          boneNodes.push_back(std::make_pair(dBone.node, dBone.boneIndx));
         }
-      }
 
-      if (!keysframesLeft)
-      {
-        break;
+        boneNodes.push_back(std::make_pair(dBone.node, dBone.boneIndx));
       }
 
       // After getting all node transformations re-calculate dirty nodes transformations
@@ -678,11 +790,37 @@ namespace ToolKit
         const Mat4 boneTransform  = node.first->GetTransform(TransformationSpace::TS_WORLD);
         const Mat4 totalTransform = boneTransform * sBone->m_inverseWorldMatrix;
 
-        uint loc                  = ((keyframeIndex * (uint) skeleton->m_bones.size() + node.second) * sizeOfElement);
-        memcpy(buffer + loc, &totalTransform, sizeOfElement);
+        Vec4* boneTexels          = texels.data() + (keyframeIndex * boneCount + node.second) * BoneTransformTexelCount;
+        PackBoneTransform(totalTransform, boneTexels);
+
+        for (int i = 0; i < BoneTransformTexelCount; i++)
+        {
+          Vec4 magnitude = glm::abs(boneTexels[i]);
+          magnitude      = glm::max(magnitude, Vec4(magnitude.z, magnitude.w, magnitude.x, magnitude.y));
+          maxComponent   = glm::max(maxComponent, glm::max(magnitude.x, magnitude.y));
+        }
       }
+    }
 
-      ++keyframeIndex;
+    // Half precision halves the memory. Translation is split in its half precision value and its rounding error, half
+    // precision step grows with the magnitude and would make the vertices jitter far from the origin.
+    bool halfPrecision = allowHalfPrecision && maxComponent <= HalfPrecisionAnimationRange;
+
+    std::vector<uint16> halfTexels;
+    if (halfPrecision)
+    {
+      halfTexels.resize(texels.size() * 4);
+      for (size_t i = 0; i < texels.size(); i += BoneTransformTexelCount)
+      {
+        Vec4* boneTexels = texels.data() + i;
+        Vec4 translation = Vec4(boneTexels[0].w, boneTexels[1].w, boneTexels[2].w, 0.0f);
+        boneTexels[3]    = translation - glm::unpackHalf4x16(glm::packHalf4x16(translation));
+
+        for (size_t j = 0; j < BoneTransformTexelCount * 4; j++)
+        {
+          halfTexels[i * 4 + j] = glm::packHalf1x16(boneTexels[j / 4][j % 4]);
+        }
+      }
     }
 
     TextureSettings dataTextureSettings;
@@ -690,13 +828,11 @@ namespace ToolKit
     dataTextureSettings.WarpS          = GraphicTypes::UVClampToEdge;
     dataTextureSettings.WarpT          = GraphicTypes::UVClampToEdge;
     dataTextureSettings.WarpR          = GraphicTypes::UVClampToEdge;
-    dataTextureSettings.InternalFormat = GraphicTypes::FormatRGBA32F;
+    dataTextureSettings.InternalFormat = halfPrecision ? GraphicTypes::FormatRGBA16F : GraphicTypes::FormatRGBA32F;
     dataTextureSettings.Format         = GraphicTypes::FormatRGBA;
-    dataTextureSettings.Type           = GraphicTypes::TypeFloat;
-    DataTexturePtr animDataTexture     = MakeNewPtr<DataTexture>(width, maxKeyCount, dataTextureSettings);
-    animDataTexture->Init((void*) buffer);
-
-    SafeDelArray(buffer);
+    dataTextureSettings.Type           = halfPrecision ? GraphicTypes::TypeHalfFloat : GraphicTypes::TypeFloat;
+    DataTexturePtr animDataTexture     = MakeNewPtr<DataTexture>(width, keyCount, dataTextureSettings);
+    animDataTexture->Init(halfPrecision ? (void*) halfTexels.data() : (void*) texels.data());
 
     return animDataTexture;
   }
@@ -71,8 +71,9 @@ namespace ToolKit
     /**
      * Sets the Skeleton's transform from the animation based on time.
      * @param skeleton SkeletonPtr to be transformed.
+     * @param weight is the weight of this animation's pose, blended with the current pose of the bones if less than 1.
      */
-    void GetPose(const SkeletonComponentPtr& skeleton, float time);
+    void GetPose(const SkeletonComponentPtr& skeleton, float time, float weight = 1.0f);
 
     /**
      * Sets the Node's transform from the animation based on frame.
@@ -271,8 +272,9 @@ namespace ToolKit
 
     /**
      * Creates and returns animation data texture for given skeleton and animation
+     * @param allowHalfPrecision bakes the texture in half precision if the bone matrices are in its range.
      */
-    DataTexturePtr CreateAnimationDataTexture(SkeletonPtr skeleton, AnimationPtr anim);
+    DataTexturePtr CreateAnimationDataTexture(SkeletonPtr skeleton, AnimationPtr anim, bool allowHalfPrecision);
 
    public:
     /** Global time multiplier for all track in the player. */
@@ -85,4 +85,159 @@ namespace ToolKit
     return packed;
   }
 
+  void BinPack2D::Reset(int atlasSize)
+  {
+    m_layers.clear();
+    m_atlasSize = atlasSize;
+  }
+
+  bool BinPack2D::Allocate(int size, int count, int maxLayers, Run& run)
+  {
+    assert(size > 0 && size <= m_atlasSize && "Square can't fit into atlas.");
+
+    int slotsPerRow   = m_atlasSize / size;
+    int slotsPerLayer = slotsPerRow * slotsPerRow;
+
+    run.size          = size;
+    run.count         = count;
+    run.layer         = -1;
+    run.slot          = -1;
+
+    auto markFn       = [&]() -> void
+    {
+      for (int i = 0; i < count; i++)
+      {
+        int slot     = run.slot + i;
+        Layer& layer = m_layers[run.layer + slot / slotsPerLayer];
+        if (layer.size != size)
+        {
+          layer.size = size;
+          layer.slots.assign(slotsPerLayer, false);
+        }
+
+        layer.slots[slot % slotsPerLayer] = true;
+        layer.usedSlots++;
+      }
+    };
+
+    if (count <= slotsPerLayer)
+    {
+      // First fit into the layers of the same size, or the empty ones.
+      for (int layerIndx = 0; layerIndx < (int) m_layers.size(); layerIndx++)
+      {
+        Layer& layer = m_layers[layerIndx];
+        if (layer.usedSlots == 0)
+        {
+          run.layer = layerIndx;
+          run.slot  = 0;
+          markFn();
+          return true;
+        }
+
+        if (layer.size != size)
+        {
+          continue;
+        }
+
+        int freeCount = 0;
+        for (int slot = 0; slot < slotsPerLayer; slot++)
+        {
+          freeCount = layer.slots[slot] ? 0 : freeCount + 1;
+          if (freeCount == count)
+          {
+            run.layer = layerIndx;
+            run.slot  = slot - count + 1;
+            markFn();
+            return true;
+          }
+        }
+      }
+    }
+    else
+    {
+      // Run spans consecutive empty layers.
+      int layerCount = (count + slotsPerLayer - 1) / slotsPerLayer;
+      int emptyCount = 0;
+      for (int layerIndx = 0; layerIndx < (int) m_layers.size(); layerIndx++)
+      {
+        emptyCount = m_layers[layerIndx].usedSlots == 0 ? emptyCount + 1 : 0;
+        if (emptyCount == layerCount)
+        {
+          run.layer = layerIndx - layerCount + 1;
+          run.slot  = 0;
+          markFn();
+          return true;
+        }
+      }
+    }
+
+    // Grow the atlas, trailing empty layers are reused.
+    int firstLayer = (int) m_layers.size();
+    while (firstLayer > 0 && m_layers[firstLayer - 1].usedSlots == 0)
+    {
+      firstLayer--;
+    }
+
+    int layerCount = (count + slotsPerLayer - 1) / slotsPerLayer;
+    if (firstLayer + layerCount > maxLayers)
+    {
+      return false;
+    }
+
+    m_layers.resize(glm::max((int) m_layers.size(), firstLayer + layerCount));
+    run.layer = firstLayer;
+    run.slot  = 0;
+    markFn();
+
+    return true;
+  }
+
+  void BinPack2D::Free(Run& run)
+  {
+    if (run.layer == -1)
+    {
+      return;
+    }
+
+    int slotsPerRow   = m_atlasSize / run.size;
+    int slotsPerLayer = slotsPerRow * slotsPerRow;
+    for (int i = 0; i < run.count; i++)
+    {
+      int slot     = run.slot + i;
+      Layer& layer = m_layers[run.layer + slot / slotsPerLayer];
+
+      layer.slots[slot % slotsPerLayer] = false;
+      layer.usedSlots--;
+    }
+
+    run.layer = -1;
+    run.slot  = -1;
+  }
+
+  BinPack2D::PackedRect BinPack2D::GetRect(const Run& run, int index) const
+  {
+    int slotsPerRow   = m_atlasSize / run.size;
+    int slotsPerLayer = slotsPerRow * slotsPerRow;
+    int slot          = run.slot + index;
+    int layerSlot     = slot % slotsPerLayer;
+
+    PackedRect rect;
+    rect.layer        = run.layer + slot / slotsPerLayer;
+    rect.coordinate.x = (float) (layerSlot % slotsPerRow * run.size);
+    rect.coordinate.y = (float) (layerSlot / slotsPerRow * run.size);
+
+    return rect;
+  }
+
+  int BinPack2D::GetLayerCount() const
+  {
+    int layerCount = (int) m_layers.size();
+    while (layerCount > 0 && m_layers[layerCount - 1].usedSlots == 0)
+    {
+      layerCount--;
+    }
+
+    return layerCount;
+  }
+
 } // namespace ToolKit
@@ -18,6 +18,8 @@ namespace ToolKit
    * Algorithm is not optimal, meaning that it may not fit all the squares tightly
    * Algorithm fallows a sequence from left to right, goes one up and left to right
    * than next layer. This sequence is expected in the shader to find the map's layer and coordinate.
+   * Allocate and Free place squares incrementally. Each layer is dedicated to a single size, so the consecutive squares
+   * of a run stay in the sequence without moving the other runs.
    */
   class BinPack2D
   {
@@ -31,6 +33,47 @@ namespace ToolKit
     typedef std::vector<PackedRect> PackedRectArray;
 
     PackedRectArray Pack(const IntArray& squares, int atlasSize, int* layerCount = nullptr);
+
+    /** Consecutive squares of the same size placed by Allocate. */
+    struct Run
+    {
+      int size  = 0;
+      int count = 0;
+      int layer = -1; //!< Layer of the first square.
+      int slot  = -1; //!< Index of the first square in its layer, squares are indexed in the packing sequence.
+    };
+
+    /** Frees all runs and sets the atlas size for the incremental packing. */
+    void Reset(int atlasSize);
+
+    /**
+     * Incrementally places count squares of the given size consecutively in the packing sequence, without moving the
+     * runs that are already placed. Each layer holds squares of a single size, runs that don't fit a layer span the
+     * following empty layers.
+     * @param maxLayers is the number of layers that the atlas can grow to.
+     * @return false if the run does not fit in maxLayers.
+     */
+    bool Allocate(int size, int count, int maxLayers, Run& run);
+
+    /** Frees the squares of the run, making them available for the following allocations. */
+    void Free(Run& run);
+
+    /** Returns the coordinate and layer of the square at the index in the run. */
+    PackedRect GetRect(const Run& run, int index) const;
+
+    /** Returns the number of layers that the placed runs span. */
+    int GetLayerCount() const;
+
+   private:
+    struct Layer
+    {
+      int size      = 0; //!< Size of the squares in the layer. Zero if the layer is empty.
+      int usedSlots = 0;
+      BoolArray slots;
+    };
+
+    std::vector<Layer> m_layers;
+    int m_atlasSize = 0;
   };
 
 } // namespace ToolKit
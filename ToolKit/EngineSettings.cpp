@@ -117,7 +117,13 @@ namespace ToolKit
     WriteAttr(settings, doc, "PSSMLambda", std::to_string(parallelSplitLambda));
     WriteAttr(settings, doc, "StableShadow", std::to_string(stableShadowMap));
     WriteAttr(settings, doc, "Use32BitSM", std::to_string(use32BitShadowMap));
+    WriteAttr(settings, doc, "ShadowMapUpdateBudget", std::to_string(shadowMapUpdateBudget));
+    WriteAttr(settings, doc, "ShadowCascadeUpdateInterval", std::to_string(shadowCascadeUpdateInterval));
+    WriteAttr(settings, doc, "AdaptiveShadowResolution", std::to_string(adaptiveShadowResolution));
+    WriteAttr(settings, doc, "ShadowAtlasBudgetMB", std::to_string(shadowAtlasBudgetMB));
 
+    WriteAttr(settings, doc, "UseBonePaletteSkinning", std::to_string(useBonePaletteSkinning));
+    WriteAttr(settings, doc, "UseHalfPrecisionAnimations", std::to_string(useHalfPrecisionAnimations));
     WriteAttr(settings, doc, "AnisotropicTextureFiltering", std::to_string(anisotropicTextureFiltering));
 
     WriteAttr(settings, doc, "MaxEntityPerBVHNode", std::to_string(maxEntityPerBVHNode));
@@ -150,6 +156,13 @@ namespace ToolKit
       ReadAttr(node, "PSSMLambda", parallelSplitLambda);
       ReadAttr(node, "StableShadow", stableShadowMap);
       ReadAttr(node, "Use32BitSM", use32BitShadowMap);
+      ReadAttr(node, "ShadowMapUpdateBudget", shadowMapUpdateBudget);
+      ReadAttr(node, "ShadowCascadeUpdateInterval", shadowCascadeUpdateInterval);
+      ReadAttr(node, "AdaptiveShadowResolution", adaptiveShadowResolution);
+      ReadAttr(node, "ShadowAtlasBudgetMB", shadowAtlasBudgetMB);
+
+      ReadAttr(node, "UseBonePaletteSkinning", useBonePaletteSkinning);
+      ReadAttr(node, "UseHalfPrecisionAnimations", useHalfPrecisionAnimations);
 
       ReadAttr(node, "AnisotropicTextureFiltering", anisotropicTextureFiltering);
 
@@ -89,6 +89,39 @@ namespace ToolKit
       /** Uses 32 bit shadow maps. */
       bool use32BitShadowMap            = true;
 
+      /**
+       * Maximum number of shadow maps, cascades or cube faces, rendered in a frame. Maps that exceed the budget keep
+       * their last content and are updated in the following frames. 0 disables the limit.
+       */
+      int shadowMapUpdateBudget         = 0;
+
+      /** Cascades after the first one are refreshed once in this many frames, in turns. 1 refreshes all every frame. */
+      int shadowCascadeUpdateInterval   = 1;
+
+      /**
+       * Picks the shadow resolution of point and spot lights each frame by their screen coverage, up to their
+       * ShadowRes. Only the lights whose resolution tier changes are moved in the shadow atlas.
+       */
+      bool adaptiveShadowResolution     = true;
+
+      /**
+       * Memory budget of the shadow atlas in megabytes. Lights with the least screen coverage are downscaled until the
+       * shadow maps fit. 0 disables the limit.
+       */
+      int shadowAtlasBudgetMB           = 0;
+
+      /**
+       * Poses the skeletons on the cpu and uploads their bone matrices each frame, instead of sampling the animations
+       * baked into textures. Frees the baked animation textures.
+       */
+      bool useBonePaletteSkinning       = false;
+
+      /**
+       * Bakes the animation textures in half precision, which halves their memory. Only used for the skinned meshes
+       * that stay close to their origin, the rest are baked in 32 bit.
+       */
+      bool useHalfPrecisionAnimations   = false;
+
       /** Anisotropic texture filtering value. It can be 0, 2 ,4, 8, 16. Clamped with gpu max anisotropy. */
       int anisotropicTextureFiltering   = 8;
 
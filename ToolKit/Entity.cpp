@@ -131,6 +131,11 @@ namespace ToolKit
       envComp->m_spatialCachesInvalidated = true;
     }
 
+    if (MeshComponent* meshComp = GetComponentFast<MeshComponent>())
+    {
+      meshComp->InvalidateRenderJobs();
+    }
+
     if (m_aabbTreeNodeProxy != AABBTree::nullNode)
     {
       if (ScenePtr scene = m_scene.lock())
@@ -166,7 +171,14 @@ namespace ToolKit
     TransformLock_Define(false, EntityCategory.Name, EntityCategory.Priority, true, true);
   }
 
-  void Entity::ParameterEventConstructor() { Super::ParameterEventConstructor(); }
+  void Entity::ParameterEventConstructor()
+  {
+    Super::ParameterEventConstructor();
+
+    // Visibility is a category of the entity in the aabb tree.
+    ParamVisible().m_onValueChangedFn.push_back([this](Value& oldVal, Value& newVal) -> void
+                                                { InvalidateSpatialCaches(); });
+  }
 
   void Entity::WeakCopy(Entity* other, bool copyComponents) const
   {
@@ -191,6 +203,9 @@ namespace ToolKit
     assert(GetComponent(component->Class()) == nullptr && "Component has already been added.");
     component->OwnerEntity(Self<Entity>());
     m_components.push_back(component);
+
+    // Components may change the bounding box and the categories in the aabb tree.
+    InvalidateSpatialCaches();
   }
 
   MeshComponentPtr Entity::GetMeshComponent() const { return GetComponent<MeshComponent>(); }
@@ -205,6 +220,7 @@ namespace ToolKit
       {
         ComponentPtr cmp = m_components[i];
         m_components.erase(m_components.begin() + i);
+        InvalidateSpatialCaches();
         return cmp;
       }
     }
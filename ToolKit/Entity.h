@@ -67,6 +67,9 @@ namespace ToolKit
       std::shared_ptr<T> component = MakeNewPtr<T>(componentSerializable);
       component->OwnerEntity(Self<Entity>());
       m_components.push_back(component);
+
+      // Components may change the bounding box and the categories in the aabb tree.
+      InvalidateSpatialCaches();
       return component;
     }
 
@@ -98,6 +101,7 @@ namespace ToolKit
         {
           ComponentPtr cmp = m_components[i];
           m_components.erase(m_components.begin() + i);
+          InvalidateSpatialCaches();
           return cmp;
         }
       }
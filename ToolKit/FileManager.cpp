@@ -69,6 +69,8 @@ namespace ToolKit
 
   FileManager::FileDataType FileManager::GetFile(FileType fileType, ImageFileInfo& fileInfo)
   {
+    std::lock_guard<std::mutex> fileLock(m_fileLock);
+
     String pakPath      = ConcatPaths({ResourcePath(), "..", "MinResources.pak"});
 
     // Get relative path from Resources directory
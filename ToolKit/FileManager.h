@@ -104,6 +104,7 @@ namespace ToolKit
     std::unordered_map<String, std::pair<uint64, uint>> m_zipFilesOffsetTable;
     bool m_offsetTableCreated = false;
     ZipFile m_zfile           = nullptr;
+    std::mutex m_fileLock; //!< Serializes file reads. Pak file handle and image loader states are shared.
 
    public:
     bool m_ignorePakFile = false;
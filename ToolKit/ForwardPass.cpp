@@ -44,6 +44,7 @@ namespace ToolKit
 
     renderer->SetFramebuffer(m_params.FrameBuffer, m_params.clearBuffer);
     renderer->SetCamera(m_params.Cam, true);
+    renderer->SetLightGrid(m_params.lightGrid);
 
     // Adjust the depth test considering z-pre pass.
     if (m_params.hasForwardPrePass)
@@ -65,6 +66,7 @@ namespace ToolKit
     // Set the default depth test.
     Renderer* renderer = GetRenderer();
     renderer->SetDepthTestFunc(CompareFunctions::FuncLess);
+    renderer->SetLightGrid(nullptr);
   }
 
   void ForwardRenderPass::RenderOpaque(RenderData* renderData)
@@ -105,7 +107,7 @@ namespace ToolKit
 
     RenderJobItr begin = renderData->GetForwardTranslucentBegin();
     RenderJobItr end   = renderData->jobs.end();
-    RenderJobProcessor::SortByDistanceToCamera(begin, end, m_params.Cam);
+    RenderJobProcessor::SortByDistanceToCamera(renderData->jobs, begin, end, m_params.Cam);
 
     if (begin != end)
     {
@@ -115,7 +117,7 @@ namespace ToolKit
       {
         if (job->Material->IsShaderMaterial())
         {
-          renderer->RenderWithProgramFromMaterial(*job);
+          renderer->RenderWithProgramFromMaterial(renderData->jobs, *job);
         }
         else
         {
@@ -125,16 +127,16 @@ namespace ToolKit
           if (mat->GetRenderState()->cullMode == CullingType::TwoSided)
           {
             mat->GetRenderState()->cullMode = CullingType::Front;
-            renderer->Render(*job);
+            renderer->Render(renderData->jobs, *job);
 
             mat->GetRenderState()->cullMode = CullingType::Back;
-            renderer->Render(*job);
+            renderer->Render(renderData->jobs, *job);
 
             mat->GetRenderState()->cullMode = CullingType::TwoSided;
           }
           else
           {
-            renderer->Render(*job);
+            renderer->Render(renderData->jobs, *job);
           }
         }
       }
@@ -154,12 +156,12 @@ namespace ToolKit
     {
       if (job->Material->IsShaderMaterial())
       {
-        renderer->RenderWithProgramFromMaterial(*job);
+        renderer->RenderWithProgramFromMaterial(renderData->jobs, *job);
       }
       else
       {
         renderer->BindProgram(defaultGpuProgram);
-        renderer->Render(*job);
+        renderer->Render(renderData->jobs, *job);
       }
     }
   }
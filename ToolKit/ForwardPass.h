@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include "LightGrid.h"
 #include "Pass.h"
 
 namespace ToolKit
@@ -18,12 +19,13 @@ namespace ToolKit
     CameraPtr Cam                = nullptr;
     FramebufferPtr FrameBuffer   = nullptr;
     RenderTargetPtr SsaoTexture  = nullptr;
+    const LightGrid* lightGrid   = nullptr; //!< Lights of the camera. If null, jobs are rendered without lights.
     GraphicBitFields clearBuffer = GraphicBitFields::AllBits;
     bool hasForwardPrePass       = false;
   };
 
   /**
-   * Renders given entities with given lights using forward rendering
+   * Renders given entities with the lights of the given light grid using forward rendering
    */
   class TK_API ForwardRenderPass : public Pass
   {
@@ -78,7 +78,7 @@ namespace ToolKit
 
     for (RenderJobItr job = begin; job != end; job++)
     {
-      renderer->Render(*job);
+      renderer->Render(m_params.renderData->jobs, *job);
     }
 
     begin = m_params.renderData->GetForwardAlphaMaskedBegin();
@@ -90,7 +90,7 @@ namespace ToolKit
 
     for (RenderJobItr job = begin; job != end; job++)
     {
-      renderer->Render(*job);
+      renderer->Render(m_params.renderData->jobs, *job);
     }
   }
 
@@ -119,8 +119,10 @@ namespace ToolKit
 
   void ForwardSceneRenderPath::SetPassParams()
   {
+    // Only meshes and lights are needed, other entities are skipped in the tree.
+    const uint categories      = AABBTree::CategoryMesh | AABBTree::CategoryLight;
     Frustum frustum            = ExtractFrustum(m_params.Cam->GetProjectViewMatrix(), false);
-    EntityRawPtrArray entities = m_params.Scene->m_aabbTree.VolumeQuery(frustum);
+    EntityRawPtrArray entities = m_params.Scene->m_aabbTree.VolumeQuery(frustum, false, categories);
 
     if (m_params.grid != nullptr)
     {
@@ -160,14 +162,19 @@ namespace ToolKit
 
     int dirEndIndx                                   = RenderJobProcessor::PreSortLights(lights);
     const EnvironmentComponentPtrArray& environments = m_params.Scene->GetEnvironmentVolumes();
-    RenderJobProcessor::CreateRenderJobs(m_renderData.jobs, entities, false, dirEndIndx, lights, environments);
+    RenderJobProcessor::CreateRenderJobs(m_renderData.jobs, entities, false, environments);
+    RenderJobProcessor::CullRenderJobs(m_renderData.jobs, frustum);
+
+    // Lights are assigned to the clusters of the camera instead of the jobs.
+    m_lightGrid.Build(m_params.Cam, lights, dirEndIndx);
 
     m_shadowPass->m_params.scene      = m_params.Scene;
     m_shadowPass->m_params.viewCamera = m_params.Cam;
     m_shadowPass->m_params.lights     = lights;
 
     RenderJobProcessor::SeperateRenderData(m_renderData, true);
-    RenderJobProcessor::SortByMaterial(m_renderData);
+    RenderJobProcessor::SortByMaterial(m_renderData, m_params.Cam);
+    RenderJobProcessor::BatchInstances(m_renderData);
 
     // Set CubeMapPass for sky.
     m_drawSky         = false;
@@ -195,6 +202,7 @@ namespace ToolKit
     m_forwardRenderPass->m_params.Cam               = m_params.Cam;
     m_forwardRenderPass->m_params.FrameBuffer       = m_params.MainFramebuffer;
     m_forwardRenderPass->m_params.SsaoTexture       = m_params.Gfx.SSAOEnabled ? m_ssaoPass->m_ssaoTexture : nullptr;
+    m_forwardRenderPass->m_params.lightGrid         = &m_lightGrid;
     m_forwardRenderPass->m_params.clearBuffer       = GraphicBitFields::None;
 
     bool forwardPreProcessExist                     = RequiresForwardPreProcessPass();
@@ -70,6 +70,7 @@ namespace ToolKit
 
     // Cached variables
     RenderData m_renderData;
+    LightGrid m_lightGrid;
   };
 
   typedef std::shared_ptr<ForwardSceneRenderPath> SceneRenderPathPtr;
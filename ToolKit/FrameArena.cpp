@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2019-2024 OtSofware
+ * This code is licensed under the GNU Lesser General Public License v3.0 (LGPL-3.0).
+ * For more information, including options for a more permissive commercial license,
+ * please visit [otyazilim.com] or contact us at [info@otyazilim.com].
+ */
+
+#include "FrameArena.h"
+
+#include "TKStats.h"
+#include "ToolKit.h"
+
+namespace ToolKit
+{
+
+  /** Statistics flushed by the arenas of all threads during the frame. */
+  static std::atomic<uint64> g_frameArenaBytes           = 0;
+  static std::atomic<uint64> g_frameArenaAllocations     = 0;
+  static std::atomic<uint64> g_frameArenaHeapAllocations = 0;
+
+  FrameArena::FrameArena() { AddBlock(BlockSize); }
+
+  FrameArena::~FrameArena()
+  {
+    for (Block& block : m_blocks)
+    {
+      ::operator delete(block.memory, std::align_val_t(BlockAlignment));
+    }
+  }
+
+  FrameArena* FrameArena::Get()
+  {
+    static thread_local FrameArena arena;
+    return &arena;
+  }
+
+  void FrameArena::EndFrame()
+  {
+    uint64 bytes           = g_frameArenaBytes.exchange(0, std::memory_order_relaxed);
+    uint64 allocations     = g_frameArenaAllocations.exchange(0, std::memory_order_relaxed);
+    uint64 heapAllocations = g_frameArenaHeapAllocations.exchange(0, std::memory_order_relaxed);
+
+    if (TKStats* stats = GetTKStats())
+    {
+      stats->m_frameArenaBytes            = bytes;
+      stats->m_frameArenaSavedAllocations = allocations > heapAllocations ? allocations - heapAllocations : 0;
+    }
+  }
+
+  void* FrameArena::do_allocate(size_t bytes, size_t alignment)
+  {
+    assert(alignment <= BlockAlignment && "Over aligned types are not supported by the frame arena.");
+
+    size_t start = (m_offset + alignment - 1) & ~(alignment - 1);
+    while (start + bytes > m_blocks[m_blockIndex].size)
+    {
+      // Move to the next block, or allocate one if this is the last.
+      if (m_blockIndex + 1 == m_blocks.size())
+      {
+        AddBlock(bytes);
+      }
+
+      m_blockIndex++;
+      m_offset = 0;
+      start    = 0;
+    }
+
+    m_offset         = start + bytes;
+    m_lastAllocation = m_blocks[m_blockIndex].memory + start;
+    m_liveAllocations++;
+
+    m_allocatedBytes += bytes;
+    m_allocationCount++;
+
+    return m_lastAllocation;
+  }
+
+  void FrameArena::do_deallocate(void* ptr, size_t bytes, size_t alignment)
+  {
+    if (ptr == m_lastAllocation)
+    {
+      m_offset         = (std::byte*) ptr - m_blocks[m_blockIndex].memory;
+      m_lastAllocation = nullptr;
+    }
+
+    if (--m_liveAllocations == 0)
+    {
+      Rewind();
+    }
+  }
+
+  bool FrameArena::do_is_equal(const std::pmr::memory_resource& other) const noexcept { return this == &other; }
+
+  void FrameArena::Rewind()
+  {
+    if (m_blocks.size() > 1)
+    {
+      // Replace the blocks with one that holds all of them.
+      size_t totalSize = 0;
+      for (Block& block : m_blocks)
+      {
+        totalSize += block.size;
+        ::operator delete(block.memory, std::align_val_t(BlockAlignment));
+      }
+
+      m_blocks.clear();
+      AddBlock(totalSize);
+    }
+
+    m_blockIndex     = 0;
+    m_offset         = 0;
+    m_lastAllocation = nullptr;
+
+    g_frameArenaBytes.fetch_add(m_allocatedBytes, std::memory_order_relaxed);
+    g_frameArenaAllocations.fetch_add(m_allocationCount, std::memory_order_relaxed);
+    g_frameArenaHeapAllocations.fetch_add(m_heapAllocationCount, std::memory_order_relaxed);
+
+    m_allocatedBytes      = 0;
+    m_allocationCount     = 0;
+    m_heapAllocationCount = 0;
+  }
+
+  void FrameArena::AddBlock(size_t bytes)
+  {
+    size_t size   = glm::max(bytes, BlockSize);
+    size          = (size + BlockAlignment - 1) & ~(BlockAlignment - 1);
+
+    Block block   = {(std::byte*) ::operator new(size, std::align_val_t(BlockAlignment)), size};
+    m_blocks.push_back(block);
+
+    m_heapAllocationCount++;
+  }
+
+} // namespace ToolKit
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2019-2024 OtSofware
+ * This code is licensed under the GNU Lesser General Public License v3.0 (LGPL-3.0).
+ * For more information, including options for a more permissive commercial license,
+ * please visit [otyazilim.com] or contact us at [info@otyazilim.com].
+ */
+
+#pragma once
+
+#include "Types.h"
+
+#include <memory_resource>
+
+namespace ToolKit
+{
+
+  /**
+   * Linear allocator for the transient containers that live within a frame, such as query results and traversal
+   * stacks. Each thread has its own arena, allocations bump a pointer in a preallocated block and deallocations are
+   * no-ops. The arena rewinds to its beginning when all of its allocations are released, so the memory is reused by
+   * the next containers without touching the heap. Blocks are merged into a single one on rewind, after a few frames
+   * all allocations of a thread fit in one block.
+   *
+   * Containers using the arena must be created and destroyed on the same thread and must not outlive the frame.
+   */
+  class TK_API FrameArena : public std::pmr::memory_resource
+  {
+   public:
+    FrameArena();
+    ~FrameArena();
+
+    FrameArena(const FrameArena&)            = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    /** Returns the arena of the calling thread. */
+    static FrameArena* Get();
+
+    /** Publishes the allocation statistics of the frame to TKStats. Called by Main::FrameEnd. */
+    static void EndFrame();
+
+   protected:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* ptr, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+   private:
+    /** Releases all allocations, merges the blocks and flushes the statistics. */
+    void Rewind();
+
+    /** Allocates a new block from the heap that can hold at least the given bytes. */
+    void AddBlock(size_t bytes);
+
+   private:
+    static constexpr size_t BlockSize      = 64 * 1024;
+    static constexpr size_t BlockAlignment = 64;
+
+    struct Block
+    {
+      std::byte* memory;
+      size_t size;
+    };
+
+    std::vector<Block> m_blocks;
+    size_t m_blockIndex          = 0;       //!< Block that the allocations are served from.
+    size_t m_offset              = 0;       //!< Beginning of the free space in the current block.
+    void* m_lastAllocation       = nullptr; //!< Rolled back if it is deallocated first, which vectors do on growth.
+    int m_liveAllocations        = 0;       //!< Arena rewinds when this drops to zero.
+
+    uint64 m_allocatedBytes      = 0;       //!< Bytes served since the last flush.
+    uint64 m_allocationCount     = 0;       //!< Allocations served since the last flush.
+    uint64 m_heapAllocationCount = 0;       //!< Blocks allocated from the heap since the last flush.
+  };
+
+  /** Vector that allocates from the frame arena. Construct with FrameArena::Get(). */
+  template <typename T>
+  using FrameArray = std::pmr::vector<T>;
+
+} // namespace ToolKit
@@ -89,6 +89,13 @@ namespace ToolKit
       return BoundingBox(glm::min(b1.min, b2.min), glm::max(b1.max, b2.max));
     }
 
+    /** Checks if the given bounding box is completely inside of this bounding box. */
+    inline bool Contains(const BoundingBox& bb) const
+    {
+      return min.x <= bb.min.x && min.y <= bb.min.y && min.z <= bb.min.z && bb.max.x <= max.x &&
+             bb.max.y <= max.y && bb.max.z <= max.z;
+    }
+
     /**
      * Get the volume of the bounding box.
      * @return The volume of the bounding box.
@@ -126,6 +133,8 @@ namespace ToolKit
     inline float GetDepth() const { return max.z - min.z; }
   };
 
+  typedef std::vector<BoundingBox> BoundingBoxArray;
+
   static const BoundingBox infinitesimalBox(Vec3(-TK_FLT_MIN), Vec3(TK_FLT_MIN));
   static const BoundingBox unitBox({-0.5f, -0.5f, -0.5f}, {0.5f, 0.5f, 0.5f});
 
@@ -138,6 +147,8 @@ namespace ToolKit
     Vec3 direction; //!< The direction of the ray.
   };
 
+  typedef std::vector<Ray> RayArray;
+
   /**
    * A struct representing a plane equation in 3D space.
    * Plane equation: ax+by+cz+(-d)=0
@@ -157,6 +168,8 @@ namespace ToolKit
     PlaneEquation planes[6]; // Left - Right - Top - Bottom - Near - Far
   };
 
+  typedef std::vector<Frustum> FrustumArray;
+
   /**
    * A struct representing a bounding sphere in 3D space.
    */
@@ -46,7 +46,7 @@ namespace ToolKit
     ShaderPtrArray m_shaders;
     ULongID m_activeMaterialID      = 0;
     ULongID m_activeMaterialVersion = 0;
-    uint16 m_lightCacheVersion      = 0;
+    uint64 m_lightGridVersion       = 0;
 
    private:
     std::unordered_map<Uniform, int> m_defaultUniformLocation;
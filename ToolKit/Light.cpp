@@ -81,7 +81,6 @@ namespace ToolKit
     {
       if (GetCastShadowVal())
       {
-        m_shadowResolutionUpdated  = true;
         m_invalidatedForLightCache = true;
       }
     };
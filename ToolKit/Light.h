@@ -64,15 +64,15 @@ namespace ToolKit
 
     Mat4 m_shadowMapCameraProjectionViewMatrix;
     CameraPtr m_shadowCamera        = nullptr;
-    bool m_shadowResolutionUpdated  = false;
     MeshPtr m_volumeMesh            = nullptr;
 
     bool m_invalidatedForLightCache = false; //<! Set this true if light data on GPU should be updated.
-    int m_lightCacheIndex    = -1; //<! Used by renderer only! The index of this light in the renderer's light cache.
-    uint16 m_drawCallVersion = 0;  //<! Used by renderer internally (Explained in LightCache.h)
 
     IntArray m_shadowAtlasLayers;  //!< Layer index in the shadow atlas for each cascade.
     Vec2Array m_shadowAtlasCoords; //!< Coordinates for each cascade in the corresponding layer.
+
+    /** Resolution of the shadow maps in the atlas. Picked by the shadow pass, ShadowRes is the upper limit. */
+    int m_shadowAtlasResolution    = 0;
   };
 
   // DirectionalLight
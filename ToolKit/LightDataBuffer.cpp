@@ -11,171 +11,209 @@
 #include "EngineSettings.h"
 #include "Light.h"
 #include "RHI.h"
+#include "RenderSystem.h"
+#include "TKStats.h"
 #include "ToolKit.h"
 
 namespace ToolKit
 {
 
-  LightDataBuffer::~LightDataBuffer() { Destroy(); }
-
-  void LightDataBuffer::Init()
+  /** Fills the gpu data of the light. */
+  static void PackLight(const Light* currLight, PerLightData& data)
   {
-    assert(!m_initialized && "LightDataBuffer is already initialized!");
-
-    glGenBuffers(1, &m_lightDataBufferId);
-    RHI::BindUniformBuffer(m_lightDataBufferId);
-    glBufferData(GL_UNIFORM_BUFFER, sizeof(LightData), NULL, GL_DYNAMIC_COPY);
-
-    glGenBuffers(1, &m_lightIndicesBufferId);
-    RHI::BindUniformBuffer(m_lightIndicesBufferId);
-    glBufferData(GL_UNIFORM_BUFFER, sizeof(ActiveLightIndices), NULL, GL_DYNAMIC_COPY);
-    RHI::BindUniformBuffer(0);
-
-    m_initialized = true;
-  }
-
-  void LightDataBuffer::Destroy()
-  {
-    if (m_initialized)
+    // Point light uniforms
+    if (currLight->GetLightType() == Light::Point)
     {
-      glDeleteBuffers(1, &m_lightDataBufferId);
-      glDeleteBuffers(1, &m_lightIndicesBufferId);
+      const PointLight* pLight = static_cast<const PointLight*>(currLight);
+      data.type                = 2.0f;
+      data.pos                 = pLight->m_node->GetTranslation(TransformationSpace::TS_WORLD);
+      data.color               = pLight->GetColorVal();
+      data.intensity           = pLight->GetIntensityVal();
+      data.radius              = pLight->GetRadiusVal();
+    }
+    // Directional light uniforms
+    else if (currLight->GetLightType() == Light::Directional)
+    {
+      const DirectionalLight* dLight = static_cast<const DirectionalLight*>(currLight);
+      data.type                      = 1.0f;
+      data.color                     = dLight->GetColorVal();
+      data.intensity                 = dLight->GetIntensityVal();
+      data.dir                       = dLight->GetComponentFast<DirectionComponent>()->GetDirection();
+    }
+    // Spot light uniforms
+    else if (currLight->GetLightType() == Light::Spot)
+    {
+      const SpotLight* sLight = static_cast<const SpotLight*>(currLight);
+      data.type               = 3.0f;
+      data.color              = sLight->GetColorVal();
+      data.intensity          = sLight->GetIntensityVal();
+      data.pos                = sLight->m_node->GetTranslation(TransformationSpace::TS_WORLD);
+      data.dir                = sLight->GetComponentFast<DirectionComponent>()->GetDirection();
+      data.radius             = sLight->GetRadiusVal();
+      data.outAngle           = glm::cos(glm::radians(sLight->GetOuterAngleVal() / 2.0f));
+      data.innAngle           = glm::cos(glm::radians(sLight->GetInnerAngleVal() / 2.0f));
     }
-  }
 
-  void LightDataBuffer::UpdateLightCache(LightPtr* cachedLights, int size)
-  {
-    const EngineSettings::GraphicSettings& graphicSettings = GetEngineSettings().Graphics;
-    m_lightData.cascadeDistances.x                         = graphicSettings.cascadeDistances[0];
-    m_lightData.cascadeDistances.y                         = graphicSettings.cascadeDistances[1];
-    m_lightData.cascadeDistances.z                         = graphicSettings.cascadeDistances[2];
-    m_lightData.cascadeDistances.w                         = graphicSettings.cascadeDistances[3];
+    bool isShadowCaster = currLight->GetCastShadowVal();
 
-    for (int i = 0; i < size; i++)
+    if (isShadowCaster)
     {
-      if (cachedLights[i] == nullptr)
+      const int PCFSamples = currLight->GetPCFSamplesVal();
+      if (currLight->GetLightType() == Light::LightType::Directional)
       {
-        continue;
-      }
+        const DirectionalLight* dLight = static_cast<const DirectionalLight*>(currLight);
+        data.shadowAtlasLayer          = (float) dLight->m_shadowAtlasLayers[0];
+        data.shadowAtlasCoord          = dLight->m_shadowAtlasCoords[0];
 
-      const Light* currLight = cachedLights[i].get();
+        const int cascades             = GetEngineSettings().Graphics.cascadeCount;
+        for (int ii = 0; ii < cascades; ii++)
+        {
+          const Mat4& cascadeMatrix       = dLight->m_shadowMapCascadeCameraProjectionViewMatrices[ii];
+          data.projectionViewMatrices[ii] = cascadeMatrix;
+        }
 
-      // Point light uniforms
-      if (currLight->GetLightType() == Light::Point)
-      {
-        const PointLight* pLight              = static_cast<const PointLight*>(currLight);
-        m_lightData.perLightData[i].type      = 2;
-        m_lightData.perLightData[i].pos       = pLight->m_node->GetTranslation(TransformationSpace::TS_WORLD);
-        m_lightData.perLightData[i].color     = pLight->GetColorVal();
-        m_lightData.perLightData[i].intensity = pLight->GetIntensityVal();
-        m_lightData.perLightData[i].radius    = pLight->GetRadiusVal();
+        data.numOfCascades = (float) cascades;
       }
-      // Directional light uniforms
-      else if (currLight->GetLightType() == Light::Directional)
+      else if (currLight->GetLightType() == Light::LightType::Point)
       {
-        const DirectionalLight* dLight        = static_cast<const DirectionalLight*>(currLight);
-        m_lightData.perLightData[i].type      = 1;
-        m_lightData.perLightData[i].color     = dLight->GetColorVal();
-        m_lightData.perLightData[i].intensity = dLight->GetIntensityVal();
-        m_lightData.perLightData[i].dir       = dLight->GetComponentFast<DirectionComponent>()->GetDirection();
+        // Provide layer.
+        data.shadowAtlasLayer = (float) currLight->m_shadowAtlasLayers[0];
+
+        // Provide coordinate.
+        data.shadowAtlasCoord = currLight->m_shadowAtlasCoords[0];
       }
-      // Spot light uniforms
-      else if (currLight->GetLightType() == Light::Spot)
+      else
       {
-        const SpotLight* sLight               = static_cast<const SpotLight*>(currLight);
-        m_lightData.perLightData[i].type      = 3;
-        m_lightData.perLightData[i].color     = sLight->GetColorVal();
-        m_lightData.perLightData[i].intensity = sLight->GetIntensityVal();
-        m_lightData.perLightData[i].pos       = sLight->m_node->GetTranslation(TransformationSpace::TS_WORLD);
-        m_lightData.perLightData[i].dir       = sLight->GetComponentFast<DirectionComponent>()->GetDirection();
-        m_lightData.perLightData[i].radius    = sLight->GetRadiusVal();
-        m_lightData.perLightData[i].outAngle  = glm::cos(glm::radians(sLight->GetOuterAngleVal() / 2.0f));
-        m_lightData.perLightData[i].innAngle  = glm::cos(glm::radians(sLight->GetInnerAngleVal() / 2.0f));
+        assert(currLight->GetLightType() == Light::LightType::Spot);
+
+        data.projectionViewMatrices[0] = currLight->m_shadowMapCameraProjectionViewMatrix;
+        data.shadowAtlasLayer          = (float) currLight->m_shadowAtlasLayers[0];
+        data.shadowAtlasCoord          = currLight->m_shadowAtlasCoords[0];
       }
 
-      bool isShadowCaster = currLight->GetCastShadowVal();
+      data.shadowMapCameraFar  = currLight->m_shadowCamera->Far();
+      data.BleedingReduction   = currLight->GetBleedingReductionVal();
+      data.PCFSamples          = (float) PCFSamples;
+      data.PCFRadius           = currLight->GetPCFRadiusVal();
 
-      if (isShadowCaster)
-      {
-        const int PCFSamples = currLight->GetPCFSamplesVal();
-        if (currLight->GetLightType() == Light::LightType::Directional)
-        {
-          const DirectionalLight* dLight               = static_cast<const DirectionalLight*>(currLight);
-          m_lightData.perLightData[i].shadowAtlasLayer = dLight->m_shadowAtlasLayers[0];
-          m_lightData.perLightData[i].shadowAtlasCoord = dLight->m_shadowAtlasCoords[0];
-
-          const int cascades                           = graphicSettings.cascadeCount;
-          for (int ii = 0; ii < cascades; ii++)
-          {
-            const Mat4& cascadeMatrix = dLight->m_shadowMapCascadeCameraProjectionViewMatrices[ii];
-            m_lightData.perLightData[i].projectionViewMatrices[ii] = cascadeMatrix;
-          }
-
-          m_lightData.perLightData[i].numOfCascades = cascades;
-        }
-        else if (currLight->GetLightType() == Light::LightType::Point)
-        {
-          // Provide layer.
-          m_lightData.perLightData[i].shadowAtlasLayer = currLight->m_shadowAtlasLayers[0];
+      float ratio              = (float) currLight->m_shadowAtlasResolution / RHIConstants::ShadowAtlasTextureSize;
+      data.shadowAtlasResRatio = ratio;
+      data.shadowBias          = currLight->GetShadowBiasVal() * RHIConstants::ShadowBiasMultiplier;
+    }
 
-          // Provide coordinate.
-          m_lightData.perLightData[i].shadowAtlasCoord = currLight->m_shadowAtlasCoords[0];
-        }
-        else
-        {
-          assert(currLight->GetLightType() == Light::LightType::Spot);
+    data.castShadow = isShadowCaster ? 1.0f : 0.0f;
+  }
 
-          m_lightData.perLightData[i].projectionViewMatrices[0] = currLight->m_shadowMapCameraProjectionViewMatrix;
-          m_lightData.perLightData[i].shadowAtlasLayer          = currLight->m_shadowAtlasLayers[0];
-          m_lightData.perLightData[i].shadowAtlasCoord          = currLight->m_shadowAtlasCoords[0];
-        }
+  LightDataBuffer::~LightDataBuffer() { Destroy(); }
 
-        m_lightData.perLightData[i].shadowMapCameraFar = currLight->m_shadowCamera->Far();
-        m_lightData.perLightData[i].BleedingReduction  = currLight->GetBleedingReductionVal();
-        m_lightData.perLightData[i].PCFSamples         = PCFSamples;
-        m_lightData.perLightData[i].PCFRadius          = currLight->GetPCFRadiusVal();
+  void LightDataBuffer::Init()
+  {
+    assert(!m_initialized && "LightDataBuffer is already initialized!");
 
-        float ratio = currLight->GetShadowResVal().GetValue<float>() / RHIConstants::ShadowAtlasTextureSize;
-        m_lightData.perLightData[i].shadowAtlasResRatio = ratio;
-        m_lightData.perLightData[i].shadowBias = currLight->GetShadowBiasVal() * RHIConstants::ShadowBiasMultiplier;
-      }
+    glGenTextures(1, &m_lightDataTextureId);
+    glGenTextures(1, &m_clusterTextureId);
+    glGenTextures(1, &m_lightIndexTextureId);
 
-      m_lightData.perLightData[i].castShadow = (int) isShadowCaster;
+    // Texels are only fetched, integer textures also require nearest filtering to be complete.
+    for (uint textureId : {m_lightDataTextureId, m_clusterTextureId, m_lightIndexTextureId})
+    {
+      RHI::SetTexture(GL_TEXTURE_2D, textureId);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     }
 
-    RHI::BindUniformBuffer(m_lightDataBufferId);
-    RHI::BindUniformBufferBase(m_lightDataBufferId, 0);
-    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(LightData), &m_lightData);
+    m_initialized = true;
   }
 
-  void LightDataBuffer::UpdateActiveLights(const LightRawPtrArray& lightsToRender, bool force)
+  void LightDataBuffer::Destroy()
   {
-    bool updateRequired = force;
-    uint loopLimit      = glm::min((uint) lightsToRender.size(), RHIConstants::LightCacheSize);
+    if (m_initialized)
+    {
+      GLuint textures[] = {m_lightDataTextureId, m_clusterTextureId, m_lightIndexTextureId};
+      RHI::DeleteTextures(3, textures);
 
-    if (!force)
+      m_uploadedLights.clear();
+      m_uploadedGrid = nullptr;
+      m_initialized  = false;
+    }
+  }
+
+  void LightDataBuffer::Update(const LightGrid& grid)
+  {
+    const LightRawPtrArray& lights = grid.m_lights;
+
+    // Render settings such as cascades invalidate all lights. A different set of lights shifts the rows.
+    bool lightSetChanged           = GetRenderSystem()->ConsumeGPULightCacheInvalidation();
+    lightSetChanged                = lightSetChanged || lights != m_uploadedLights;
+    bool uploadRequired            = lightSetChanged;
+    if (lightSetChanged)
+    {
+      m_uploadedLights = lights;
+      m_lightData.resize(lights.size());
+    }
+
+    for (size_t i = 0; i < lights.size(); i++)
     {
-      for (uint i = 0; i < loopLimit; i++)
+      Light* light = lights[i];
+      if (lightSetChanged || light->m_invalidatedForLightCache)
       {
-        if (m_activeLightIndices.activeLightIndices[i] != lightsToRender[i]->m_lightCacheIndex)
-        {
-          updateRequired = true;
-          break;
-        }
+        PackLight(light, m_lightData[i]);
+        light->m_invalidatedForLightCache = false;
+        uploadRequired                    = true;
       }
     }
 
-    if (updateRequired)
+    if (uploadRequired && !m_lightData.empty())
     {
-      for (uint i = 0; i < loopLimit; i++)
+      if (TKStats* stats = GetTKStats())
       {
-        m_activeLightIndices.activeLightIndices[i] = lightsToRender[i]->m_lightCacheIndex;
+        stats->m_lightCacheInvalidationPerFrame++;
       }
 
-      RHI::BindUniformBuffer(m_lightIndicesBufferId);
-      RHI::BindUniformBufferBase(m_lightIndicesBufferId, 1);
-      glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(ActiveLightIndices), &m_activeLightIndices);
+      RHI::SetTexture(GL_TEXTURE_2D, m_lightDataTextureId);
+      glTexImage2D(GL_TEXTURE_2D,
+                   0,
+                   GL_RGBA32F,
+                   PerLightDataTexelCount,
+                   (GLsizei) m_lightData.size(),
+                   0,
+                   GL_RGBA,
+                   GL_FLOAT,
+                   m_lightData.data());
     }
+
+    // Clusters are rebuilt along with the camera, upload once per build.
+    if (m_uploadedGrid == &grid && m_uploadedGridVersion == grid.m_version)
+    {
+      return;
+    }
+
+    m_uploadedGrid        = &grid;
+    m_uploadedGridVersion = grid.m_version;
+
+    RHI::SetTexture(GL_TEXTURE_2D, m_clusterTextureId);
+    glTexImage2D(GL_TEXTURE_2D,
+                 0,
+                 GL_RG32UI,
+                 LightGrid::TileCountX * LightGrid::TileCountY,
+                 LightGrid::SliceCount,
+                 0,
+                 GL_RG_INTEGER,
+                 GL_UNSIGNED_INT,
+                 grid.m_clusters.data());
+
+    RHI::SetTexture(GL_TEXTURE_2D, m_lightIndexTextureId);
+    glTexImage2D(GL_TEXTURE_2D,
+                 0,
+                 GL_R32UI,
+                 LightGrid::LightIndexRowSize,
+                 (GLsizei) (grid.m_lightIndices.size() / LightGrid::LightIndexRowSize),
+                 0,
+                 GL_RED_INTEGER,
+                 GL_UNSIGNED_INT,
+                 grid.m_lightIndices.data());
   }
 
 } // namespace ToolKit
@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include "LightGrid.h"
 #include "RHIConstants.h"
 #include "Types.h"
 
@@ -14,68 +15,52 @@ namespace ToolKit
 {
 
   /**
-   * NOTES FOR A GENERIC AND BETTER GPU CACHE
-   * The gpu cache can be generalized and every value that we write to gpu preferably should use
-   * Uniform Buffer Objects as much as possible including but not limited to Animation data, Material Data, Light data
-   * etc ... This approach minimizes the calls to gl... functions which reduces the driver over head significantly. The
-   * best way to achieve caching is, creating a template class that stores the data in the required form. This cache
-   * must have a version, when its data invalidated it must be updated for the current gpu program. Gpu program must
-   * store versions for each cache that they maintain. Invalidated caches will have a different version and gpu programs
-   * will be forced to update their version. Generally, LightDataBuffer class fallows the explained approach but it can
-   * be generalized and make better in the fallowing updates.
-   */
-
-  /**
-   * A gpu memory aligned buffer representing a single light.
+   * Gpu data of a single light.
    *
-   * The buffer in the gpu is using layout std140.
-   * To see the correct paddings, use render doc and select show paddings for the corresponding buffer.
+   * Lights are stored as rows of RGBA32F texels in the light data texture, each Vec4 of this struct is a texel. Integer
+   * values are stored as floats. The layout must match FetchLightData in lighting.shader.
    */
   struct PerLightData
   {
     /* Light properties */
     Vec3 pos;
-    int type; // 16 byte aligned with vec3.
+    float type;
 
     Vec3 dir;
-    float intensity; // 16 byte aligned with vec3.
+    float intensity;
 
     Vec3 color;
-    float radius; // 16 byte aligned with vec3.
+    float radius;
 
     float outAngle;
     float innAngle;
     float shadowMapCameraFar;
-    int numOfCascades; // 16 byte aligned with 4 x 4 bytes.
+    float numOfCascades;
 
     /* Cascade */
-    Mat4 projectionViewMatrices[RHIConstants::MaxCascadeCount]; // Vec4 per row. 16 byte aligned.
+    Mat4 projectionViewMatrices[RHIConstants::MaxCascadeCount]; // Texel per column.
 
     float BleedingReduction;
     float shadowBias;
-    int castShadow;
-    int shadowAtlasLayer;
+    float castShadow;
+    float shadowAtlasLayer;
 
-    int PCFSamples;
+    float PCFSamples;
     float PCFRadius;
     float shadowAtlasResRatio; //!< Shadow map resolution / Shadow atlas resolution. Used to find UV coordinates.
-    float pad0;                // 16 byte aligned with 4 x 4 bytes. Padding is needed to 16 byte alignment.
+    float pad0;
 
     Vec2 shadowAtlasCoord;
     Vec2 pad1;
   };
 
-  struct LightData
-  {
-    Vec4 cascadeDistances;
-    PerLightData perLightData[RHIConstants::LightCacheSize];
-  };
-
-  struct ActiveLightIndices
-  {
-    int activeLightIndices[RHIConstants::LightCacheSize];
-  };
+  /** Number of texels a light occupies in the light data texture. */
+  constexpr int PerLightDataTexelCount = sizeof(PerLightData) / sizeof(Vec4);
 
+  /**
+   * Keeps the light data and the clustered light assignment of a LightGrid on the gpu.
+   * Light data is only updated for the lights that are invalidated, or when the set of lights changes.
+   */
   class TK_API LightDataBuffer
   {
    public:
@@ -84,26 +69,21 @@ namespace ToolKit
     void Init();
     void Destroy();
 
-    /** Updates the light data in the gpu. */
-    void UpdateLightCache(LightPtr* cachedLights, int size);
-
-    /**
-     * Update active light indexes in the gpu.
-     * Checks the active light indexes with lightsToRender, update the gpu data if a it doesn't match perfectly.
-     * if force set to true, it always update active lights.
-     * Cache must be up to date, otherwise indexes points to invalidated lights.
-     */
-    void UpdateActiveLights(const LightRawPtrArray& lightsToRender, bool force = false);
+    /** Uploads the lights and the clusters of the grid to the gpu. */
+    void Update(const LightGrid& grid);
 
    public:
-    uint m_lightDataBufferId    = 0;
-    uint m_lightIndicesBufferId = 0;
+    uint m_lightDataTextureId  = 0; //!< A row of PerLightData for each light in the grid.
+    uint m_clusterTextureId    = 0; //!< Light index offset and count of each cluster.
+    uint m_lightIndexTextureId = 0; //!< Light indices of the clusters.
 
    private:
-    LightData m_lightData;
-    ActiveLightIndices m_activeLightIndices;
+    std::vector<PerLightData> m_lightData;
+    LightRawPtrArray m_uploadedLights;
+    const LightGrid* m_uploadedGrid = nullptr;
+    uint m_uploadedGridVersion      = 0;
 
-    bool m_initialized = false;
+    bool m_initialized              = false;
   };
 
 } // namespace ToolKit
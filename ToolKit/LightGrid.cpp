@@ -0,0 +1,241 @@
+/*
+ * Copyright (c) 2019-2024 OtSofware
+ * This code is licensed under the GNU Lesser General Public License v3.0 (LGPL-3.0).
+ * For more information, including options for a more permissive commercial license,
+ * please visit [otyazilim.com] or contact us at [info@otyazilim.com].
+ */
+
+#include "LightGrid.h"
+
+#include "Camera.h"
+#include "FrameArena.h"
+#include "Light.h"
+#include "Threads.h"
+#include "ToolKit.h"
+
+namespace ToolKit
+{
+
+  /** Inclusive range of clusters that a light intersects. */
+  struct LightClusterRange
+  {
+    int minTile[2];
+    int maxTile[2];
+    int minSlice;
+    int maxSlice;
+    uint lightIndex;
+    Light* light;
+    float influence; //!< Approximate screen coverage, lights with the least influence are dropped first.
+  };
+
+  void LightGrid::Build(const CameraPtr& cam, const LightRawPtrArray& lights, int dirLightEndIndex)
+  {
+    m_version++;
+    m_lights.clear();
+    m_clusters.assign(ClusterCount * 2, 0);
+    m_lightIndices.clear();
+
+    bool orthographic       = cam->IsOrtographic();
+    float nearDist          = cam->Near();
+    float farDist           = cam->Far();
+
+    // Orthographic cameras are offset to keep the depth positive for the logarithm.
+    float depthOffset       = orthographic ? 1.0f - nearDist : 0.0f;
+    float logNear           = glm::log(nearDist + depthOffset);
+    float logFar            = glm::log(farDist + depthOffset);
+    float sliceScale        = (float) SliceCount / (logFar - logNear);
+    m_slicing               = Vec3(sliceScale, -logNear * sliceScale, depthOffset);
+
+    int lightCount          = (int) lights.size();
+    m_directionalLightCount = glm::min(dirLightEndIndex, MaxLightCount);
+    int droppedLightCount   = glm::max(dirLightEndIndex - MaxLightCount, 0);
+    m_lights.insert(m_lights.end(), lights.begin(), lights.begin() + m_directionalLightCount);
+
+    // Find the clusters that each light's bounding sphere covers.
+    Mat4 view           = cam->GetViewMatrix();
+    const Mat4& project = cam->GetProjectionMatrix();
+
+    FrameArray<LightClusterRange> ranges(FrameArena::Get());
+    ranges.reserve(lightCount - m_directionalLightCount);
+
+    for (int i = m_directionalLightCount; i < lightCount; i++)
+    {
+      Light* light = lights[i];
+
+      BoundingSphere sphere;
+      if (light->GetLightType() == Light::LightType::Point)
+      {
+        sphere = static_cast<PointLight*>(light)->m_boundingSphereCache;
+      }
+      else if (light->GetLightType() == Light::LightType::Spot)
+      {
+        // Pick the tighter one of the spot range and the sphere around the cone's bounding box.
+        SpotLight* spot        = static_cast<SpotLight*>(light);
+        const BoundingBox& box = spot->m_boundingBoxCache;
+
+        sphere                 = {spot->m_node->GetTranslation(), spot->GetRadiusVal()};
+        float boxRadius        = glm::length(box.max - box.min) * 0.5f;
+        if (boxRadius < sphere.radius)
+        {
+          sphere = {box.GetCenter(), boxRadius};
+        }
+      }
+      else
+      {
+        continue;
+      }
+
+      Vec3 center = Vec3(view * Vec4(sphere.pos, 1.0f));
+      float depth = -center.z;
+      if (depth + sphere.radius < nearDist || depth - sphere.radius > farDist)
+      {
+        continue;
+      }
+
+      LightClusterRange range;
+      range.minSlice = GetSlice(depth - sphere.radius);
+      range.maxSlice = GetSlice(depth + sphere.radius);
+
+      if (!orthographic && depth - sphere.radius <= nearDist)
+      {
+        // Sphere crosses the near plane, its projection is unbounded.
+        range.minTile[0] = 0;
+        range.minTile[1] = 0;
+        range.maxTile[0] = TileCountX - 1;
+        range.maxTile[1] = TileCountY - 1;
+      }
+      else
+      {
+        // Project the corners of the sphere's view space box, all of them are in front of the camera.
+        Vec2 ndcMin(TK_FLT_MAX);
+        Vec2 ndcMax(-TK_FLT_MAX);
+        for (int corner = 0; corner < 8; corner++)
+        {
+          Vec3 sign((corner & 1) ? 1.0f : -1.0f, (corner & 2) ? 1.0f : -1.0f, (corner & 4) ? 1.0f : -1.0f);
+          Vec4 clip = project * Vec4(center + sign * sphere.radius, 1.0f);
+          Vec2 ndc  = Vec2(clip) / clip.w;
+          ndcMin    = glm::min(ndcMin, ndc);
+          ndcMax    = glm::max(ndcMax, ndc);
+        }
+
+        if (ndcMax.x < -1.0f || ndcMax.y < -1.0f || ndcMin.x > 1.0f || ndcMin.y > 1.0f)
+        {
+          continue;
+        }
+
+        const int tileCounts[2] = {TileCountX, TileCountY};
+        for (int axis = 0; axis < 2; axis++)
+        {
+          float minCoord      = (ndcMin[axis] * 0.5f + 0.5f) * tileCounts[axis];
+          float maxCoord      = (ndcMax[axis] * 0.5f + 0.5f) * tileCounts[axis];
+          range.minTile[axis] = glm::clamp((int) glm::floor(minCoord), 0, tileCounts[axis] - 1);
+          range.maxTile[axis] = glm::clamp((int) glm::floor(maxCoord), 0, tileCounts[axis] - 1);
+        }
+      }
+
+      range.light     = light;
+      range.influence = sphere.radius / (orthographic ? 1.0f : glm::max(depth, nearDist));
+      ranges.push_back(range);
+    }
+
+    // Keep the lights that cover the most of the screen when there are more than the grid can index.
+    size_t maxRangeCount = (size_t) (MaxLightCount - m_directionalLightCount);
+    if (ranges.size() > maxRangeCount)
+    {
+      std::nth_element(ranges.begin(),
+                       ranges.begin() + maxRangeCount,
+                       ranges.end(),
+                       [](const LightClusterRange& a, const LightClusterRange& b) -> bool
+                       { return a.influence > b.influence; });
+
+      droppedLightCount += (int) (ranges.size() - maxRangeCount);
+      ranges.resize(maxRangeCount);
+    }
+
+    if (droppedLightCount != m_droppedLightCount && droppedLightCount > 0)
+    {
+      TK_WRN("Light grid can index %d lights, %d lights with the least influence are dropped.",
+             MaxLightCount,
+             droppedLightCount);
+    }
+    m_droppedLightCount = droppedLightCount;
+
+    for (LightClusterRange& range : ranges)
+    {
+      range.lightIndex = (uint) m_lights.size();
+      m_lights.push_back(range.light);
+    }
+
+    if (ranges.empty())
+    {
+      m_lightIndices.resize(LightIndexRowSize, 0);
+      return;
+    }
+
+    // Each slice is filled by a single task, tasks never write to the same cluster.
+    auto fillSliceFn = [this, &ranges](int slice, bool writeIndices) -> void
+    {
+      uint* sliceClusters = m_clusters.data() + slice * TileCountX * TileCountY * 2;
+      for (const LightClusterRange& range : ranges)
+      {
+        if (slice < range.minSlice || slice > range.maxSlice)
+        {
+          continue;
+        }
+
+        for (int y = range.minTile[1]; y <= range.maxTile[1]; y++)
+        {
+          for (int x = range.minTile[0]; x <= range.maxTile[0]; x++)
+          {
+            uint* cluster = sliceClusters + (y * TileCountX + x) * 2;
+            if (cluster[1] >= MaxLightsPerCluster)
+            {
+              continue;
+            }
+
+            if (writeIndices)
+            {
+              m_lightIndices[cluster[0] + cluster[1]] = range.lightIndex;
+            }
+            cluster[1]++;
+          }
+        }
+      }
+    };
+
+    bool parallel = ranges.size() > 64;
+
+    // Count the lights of each cluster.
+    using poolstl::iota_iter;
+    std::for_each(TKExecByConditional(parallel, WorkerManager::FramePool),
+                  iota_iter<int>(0),
+                  iota_iter<int>(SliceCount),
+                  [&](int slice) { fillSliceFn(slice, false); });
+
+    // Place the clusters consecutively and reset the counts for the write pass.
+    uint offset = 0;
+    for (int cluster = 0; cluster < ClusterCount; cluster++)
+    {
+      uint count                  = m_clusters[cluster * 2 + 1];
+      m_clusters[cluster * 2]     = offset;
+      m_clusters[cluster * 2 + 1] = 0;
+      offset                     += count;
+    }
+
+    uint rowCount = glm::max(1u, (offset + LightIndexRowSize - 1) / LightIndexRowSize);
+    m_lightIndices.resize(rowCount * LightIndexRowSize, 0);
+
+    std::for_each(TKExecByConditional(parallel, WorkerManager::FramePool),
+                  iota_iter<int>(0),
+                  iota_iter<int>(SliceCount),
+                  [&](int slice) { fillSliceFn(slice, true); });
+  }
+
+  int LightGrid::GetSlice(float viewDepth) const
+  {
+    float depth = glm::max(viewDepth + m_slicing.z, TK_FLT_MIN);
+    int slice   = (int) glm::floor(glm::log(depth) * m_slicing.x + m_slicing.y);
+    return glm::clamp(slice, 0, SliceCount - 1);
+  }
+
+} // namespace ToolKit
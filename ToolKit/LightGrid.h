@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2019-2024 OtSofware
+ * This code is licensed under the GNU Lesser General Public License v3.0 (LGPL-3.0).
+ * For more information, including options for a more permissive commercial license,
+ * please visit [otyazilim.com] or contact us at [info@otyazilim.com].
+ */
+
+#pragma once
+
+#include "Types.h"
+
+namespace ToolKit
+{
+
+  /**
+   * Clustered light assignment for forward rendering.
+   *
+   * The view frustum of a camera is split into tiles on the screen and logarithmic slices in depth. Each of these
+   * clusters lists the lights whose volume intersects it. Fragments look up their lights from the cluster they fall
+   * into, so the shading cost stays bound to the lights nearby regardless of the light count in the scene.
+   * Directional lights affect every fragment, they are not listed in the clusters.
+   */
+  class TK_API LightGrid
+  {
+   public:
+    static constexpr int TileCountX           = 16;
+    static constexpr int TileCountY           = 9;
+    static constexpr int SliceCount           = 24;
+    static constexpr int ClusterCount         = TileCountX * TileCountY * SliceCount;
+    /** Maximum number of lights the grid indexes. Lights with the least screen coverage are dropped beyond this. */
+    static constexpr int MaxLightCount        = 1024;
+    /** Maximum number of lights listed in a single cluster. */
+    static constexpr uint MaxLightsPerCluster = 128;
+    /** Light indices are uploaded as a texture with this width. Update lighting.shader accordingly. */
+    static constexpr int LightIndexRowSize    = 1024;
+
+    /**
+     * Rebuilds the clusters for the camera and assigns the lights to them.
+     * @param cam is the camera that the clusters are built for.
+     * @param lights are the lights to assign. Lights must be presorted, directional lights first.
+     * @param dirLightEndIndex is the index where the non directional lights start.
+     */
+    void Build(const CameraPtr& cam, const LightRawPtrArray& lights, int dirLightEndIndex);
+
+    /** Returns the slice that contains the given view space depth. Matches the slice lookup in lighting.shader. */
+    int GetSlice(float viewDepth) const;
+
+   public:
+    /** Lights indexed by the grid. Directional lights come first, the rest are the lights listed in clusters. */
+    LightRawPtrArray m_lights;
+    int m_directionalLightCount = 0;
+
+    /** Offset and count pairs into m_lightIndices for each cluster. Tiles are x major, followed by slices. */
+    UIntArray m_clusters;
+
+    /** Light indices of all clusters packed together. Padded to full rows of LightIndexRowSize. */
+    UIntArray m_lightIndices;
+
+    /**
+     * Slice lookup parameters. Slice of a depth is log(depth + z) * x + y. z offsets the depth of orthographic cameras,
+     * whose near plane can be at zero or behind the camera.
+     */
+    Vec3 m_slicing;
+
+    uint m_version          = 0; //!< Incremented on each build.
+    int m_droppedLightCount = 0; //!< Lights that didn't fit in the last build. Warned when it changes.
+  };
+
+} // namespace ToolKit
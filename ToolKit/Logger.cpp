@@ -33,6 +33,8 @@ namespace ToolKit
 
   void Logger::Log(const String& message)
   {
+    std::lock_guard<std::mutex> logLock(m_logLock);
+
     if constexpr (TK_PLATFORM == PLATFORM::TKWeb)
     {
       String emLog = message + "\n";
@@ -54,6 +56,7 @@ namespace ToolKit
     char messageBuffer[TKMessageBufferLength];
     vsprintf(messageBuffer, msg, args);
 
+    std::lock_guard<std::mutex> logLock(m_logLock);
     m_logFile << logTypes[(int) logType] << messageBuffer << std::endl;
 
     if (m_writeConsoleFn != nullptr)
@@ -55,5 +55,6 @@ namespace ToolKit
     ClearConsoleFn m_clearConsoleFn;
     ConsoleOutputFn m_writeConsoleFn    = nullptr;
     ConsoleOutputFn m_platfromConsoleFn = nullptr;
+    std::mutex m_logLock; //!< Logs may arrive from worker threads.
   };
 } // namespace ToolKit
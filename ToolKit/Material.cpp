@@ -449,6 +449,7 @@ namespace ToolKit
 
   MaterialPtr MaterialManager::GetCopyOfUnlitMaterial(bool storeInMaterialManager)
   {
+    std::lock_guard<std::recursive_mutex> storageLock(m_storageMutex);
     ResourcePtr source = m_storage[MaterialPath("unlit.material", true)];
     return Copy<Material>(source, storeInMaterialManager);
   }
@@ -470,6 +471,7 @@ namespace ToolKit
 
   MaterialPtr MaterialManager::GetCopyOfDefaultMaterial(bool storeInMaterialManager)
   {
+    std::lock_guard<std::recursive_mutex> storageLock(m_storageMutex);
     ResourcePtr source = m_storage[MaterialPath("default.material", true)];
     return Copy<Material>(source, storeInMaterialManager);
   }
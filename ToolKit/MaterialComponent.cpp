@@ -136,21 +136,34 @@ namespace ToolKit
     return matNode;
   }
 
-  void MaterialComponent::AddMaterial(MaterialPtr mat) { m_materialList.push_back(mat); }
+  void MaterialComponent::AddMaterial(MaterialPtr mat)
+  {
+    m_materialList.push_back(mat);
+    InvalidateRenderJobs();
+  }
 
   void MaterialComponent::RemoveMaterial(uint index)
   {
     assert(m_materialList.size() >= index && "Material List overflow");
     m_materialList.erase(m_materialList.begin() + index);
+    InvalidateRenderJobs();
   }
 
   const MaterialPtrArray& MaterialComponent::GetMaterialList() const { return m_materialList; }
 
   MaterialPtrArray& MaterialComponent::GetMaterialList() { return m_materialList; }
 
+  void MaterialComponent::SetMaterial(uint index, const MaterialPtr& material)
+  {
+    assert(index < m_materialList.size() && "Material List overflow");
+    m_materialList[index] = material;
+    InvalidateRenderJobs();
+  }
+
   void MaterialComponent::UpdateMaterialList()
   {
     m_materialList.clear();
+    InvalidateRenderJobs();
 
     MeshComponentPtr meshComp;
     if (EntityPtr owner = OwnerEntity())
@@ -205,6 +218,19 @@ namespace ToolKit
     {
       m_materialList[0] = material;
     }
+
+    InvalidateRenderJobs();
+  }
+
+  void MaterialComponent::InvalidateRenderJobs()
+  {
+    if (EntityPtr owner = OwnerEntity())
+    {
+      if (MeshComponent* meshComp = owner->GetComponentFast<MeshComponent>())
+      {
+        meshComp->InvalidateRenderJobs();
+      }
+    }
   }
 
 } // namespace ToolKit
\ No newline at end of file
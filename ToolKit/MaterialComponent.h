@@ -43,11 +43,18 @@ namespace ToolKit
     const MaterialPtrArray& GetMaterialList() const;
 
     /**
-     * Access to material list.
+     * Access to material list. Cached render jobs detect the materials replaced through the list.
      * @returns Mutable material list.
      */
     MaterialPtrArray& GetMaterialList();
 
+    /**
+     * Sets the material of the mesh / submesh at the given index.
+     * @params index is the index of the mesh / submesh.
+     * @params material is the material to set.
+     */
+    void SetMaterial(uint index, const MaterialPtr& material);
+
     /**
      * Re fetches all the materials from the parent entity.
      */
@@ -76,6 +83,9 @@ namespace ToolKit
     XmlNode* DeSerializeImpV045(const SerializationFileInfo& info, XmlNode* parent);
 
    private:
+    /** Marks the cached render jobs of the owner entity for rebuild. */
+    void InvalidateRenderJobs();
+
     /**
      * Array of materials in the entity's meshes. The index of the material
      * corresponds to index of the mesh / submesh.
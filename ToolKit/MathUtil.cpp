@@ -10,6 +10,7 @@
 #include "AABBOverrideComponent.h"
 #include "Animation.h"
 #include "Camera.h"
+#include "FrameArena.h"
 #include "Mesh.h"
 #include "Node.h"
 #include "Pass.h"
@@ -427,6 +428,90 @@ namespace ToolKit
     return transformedPos;
   }
 
+  void CalculateSkinningPalette(const Skeleton* skel,
+                                DynamicBoneMapPtr dynamicBoneMap,
+                                bool isAnimated,
+                                Mat4Array& palette)
+  {
+    palette.assign(skel->m_bones.size(), Mat4(1.0f));
+
+    const DynamicBoneMap& boneMap = isAnimated ? *dynamicBoneMap : skel->m_Tpose;
+    for (const auto& [name, dBone] : boneMap.m_boneMap)
+    {
+      if (dBone.boneIndx < palette.size())
+      {
+        Mat4 boneTransform      = dBone.node->GetTransform(TransformationSpace::TS_WORLD);
+        palette[dBone.boneIndx] = boneTransform * skel->m_bones[dBone.boneIndx]->m_inverseWorldMatrix;
+      }
+    }
+  }
+
+  Vec3 CPUSkinning(const SkinVertex* vertex, const Mat4Array& palette)
+  {
+    // Blend the matrices, a single matrix vector product per vertex.
+    Mat4 skinMatrix = palette[(uint) vertex->bones[0]] * vertex->weights[0];
+    skinMatrix     += palette[(uint) vertex->bones[1]] * vertex->weights[1];
+    skinMatrix     += palette[(uint) vertex->bones[2]] * vertex->weights[2];
+    skinMatrix     += palette[(uint) vertex->bones[3]] * vertex->weights[3];
+
+    return Vec3(skinMatrix * Vec4(vertex->pos, 1.0f));
+  }
+
+  void CPUSkinning(const SkinVertex* vertices, size_t count, const Mat4Array& palette, Vec3* positions)
+  {
+    using poolstl::iota_iter;
+    std::for_each(TKExecByConditional(count > 1000, WorkerManager::FramePool),
+                  iota_iter<size_t>(0),
+                  iota_iter<size_t>(count),
+                  [&](size_t i) { positions[i] = CPUSkinning(vertices + i, palette); });
+  }
+
+  BoundingBox SkinnedBoundingBox(const SkinVertex* vertices, size_t count, const Mat4Array& palette)
+  {
+    if (count == 0)
+    {
+      return BoundingBox();
+    }
+
+    // Vertices are reduced in chunks, each chunk into its own box. Boxes are merged afterwards, workers share nothing.
+    bool parallel     = count > 4096;
+    size_t chunkCount = parallel ? glm::max(GetWorkerManager()->GetThreadCount(WorkerManager::FramePool), 1) : 1;
+    size_t chunkSize  = (count + chunkCount - 1) / chunkCount;
+    BoundingBoxArray chunkAABBs(chunkCount);
+
+    using poolstl::iota_iter;
+    std::for_each(TKExecByConditional(parallel, WorkerManager::FramePool),
+                  iota_iter<size_t>(0),
+                  iota_iter<size_t>(chunkCount),
+                  [&](size_t chunk)
+                  {
+                    // Bounds are kept in locals, the min max reduction stays in registers and vectorizes.
+                    Vec3 minPos = Vec3(TK_FLT_MAX);
+                    Vec3 maxPos = Vec3(-TK_FLT_MAX);
+                    size_t last = std::min(count, (chunk + 1) * chunkSize);
+                    for (size_t i = chunk * chunkSize; i < last; i++)
+                    {
+                      Vec3 skinnedPos = CPUSkinning(vertices + i, palette);
+                      minPos          = glm::min(minPos, skinnedPos);
+                      maxPos          = glm::max(maxPos, skinnedPos);
+                    }
+
+                    chunkAABBs[chunk] = BoundingBox(minPos, maxPos);
+                  });
+
+    BoundingBox aabb;
+    for (const BoundingBox& chunkAABB : chunkAABBs)
+    {
+      if (chunkAABB.IsValid())
+      {
+        aabb.UpdateBoundary(chunkAABB.min);
+        aabb.UpdateBoundary(chunkAABB.max);
+      }
+    }
+
+    return aabb;
+  }
+
   bool RayMeshIntersection(const Mesh* const mesh, const Ray& ray, float& t, const SkeletonComponentPtr skelComp)
   {
     float closestPickedDistance = TK_FLT_MAX;
@@ -470,22 +555,33 @@ namespace ToolKit
       }
     }
 
+    // Skin all vertices once, faces share them.
+    const SkinVertex* skinVertices = nullptr;
+    FrameArray<Vec3> skinnedPositions(FrameArena::Get());
+    if (skelComp != nullptr && mesh->IsSkinned())
+    {
+      const SkinMesh* skinMesh = static_cast<const SkinMesh*>(mesh);
+      skinVertices             = skinMesh->m_clientSideVertices.data();
+      skinnedPositions.resize(skinMesh->m_clientSideVertices.size());
+
+      Mat4Array palette;
+      CalculateSkinningPalette(skinMesh->m_skeleton.get(), skelComp->m_map, isAnimated, palette);
+      CPUSkinning(skinVertices, skinnedPositions.size(), palette, skinnedPositions.data());
+    }
+
     std::mutex updateHit;
     std::for_each(TKExecByConditional(mesh->m_faces.size() > 100, WorkerManager::FramePool),
                   mesh->m_faces.begin(),
                   mesh->m_faces.end(),
-                  [&updateHit, &t, &closestPickedDistance, &ray, &hit, skelComp, mesh, &isAnimated](const Face& face)
+                  [&](const Face& face)
                   {
                     Vec3 positions[3] = {face.vertices[0]->pos, face.vertices[1]->pos, face.vertices[2]->pos};
-                    if (skelComp != nullptr && mesh->IsSkinned())
+                    if (skinVertices != nullptr)
                     {
-                      SkinMesh* skinMesh = (SkinMesh*) mesh;
                       for (uint vertexIndx = 0; vertexIndx < 3; vertexIndx++)
                       {
-                        positions[vertexIndx] = CPUSkinning((SkinVertex*) face.vertices[vertexIndx],
-                                                            skinMesh->m_skeleton.get(),
-                                                            skelComp->m_map,
-                                                            isAnimated);
+                        size_t index          = (const SkinVertex*) face.vertices[vertexIndx] - skinVertices;
+                        positions[vertexIndx] = skinnedPositions[index];
                       }
                     }
                     float dist = TK_FLT_MAX;
@@ -761,9 +857,9 @@ namespace ToolKit
 
     for (int i = 0; i < (int) jobs.size(); i++)
     {
-      if (!FrustumTest(frustum, jobs[i].BoundingBox))
+      if (!FrustumTest(frustum, jobs.GetBoundingBox(jobs[i])))
       {
-        unCulledJobs.push_back(jobs[i]);
+        unCulledJobs.Add(jobs, jobs[i]);
       }
     }
   }
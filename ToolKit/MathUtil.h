@@ -8,6 +8,7 @@
 #pragma once
 
 #include "GeometryTypes.h"
+#include "RenderJob.h"
 
 namespace ToolKit
 {
@@ -69,11 +70,37 @@ namespace ToolKit
 
   TK_API bool RayTriangleIntersection(const Ray& ray, const Vec3& v0, const Vec3& v1, const Vec3& v2, float& t);
 
+  /**
+   * Skins a single vertex, its bones are looked up by name. Use the palette versions to skin many vertices.
+   */
   TK_API Vec3 CPUSkinning(const class SkinVertex* vertex,
                           const Skeleton* skel,
                           DynamicBoneMapPtr dynamicBoneMap,
                           bool isAnimated);
 
+  /**
+   * Calculates the skinning matrices of the skeleton's bones, indexed by bone. Calculate once per pose and skin the
+   * vertices with it.
+   * @param isAnimated uses the pose of the dynamic bone map if true, otherwise the skeleton's bind pose.
+   * @param palette is the array that the matrices are written to.
+   */
+  TK_API void CalculateSkinningPalette(const Skeleton* skel,
+                                       DynamicBoneMapPtr dynamicBoneMap,
+                                       bool isAnimated,
+                                       Mat4Array& palette);
+
+  /** Skins a single vertex with the bone matrix palette. */
+  TK_API Vec3 CPUSkinning(const class SkinVertex* vertex, const Mat4Array& palette);
+
+  /**
+   * Skins the vertices with the bone matrix palette in parallel.
+   * @param positions must hold count elements, skinned position of each vertex is written to it.
+   */
+  TK_API void CPUSkinning(const class SkinVertex* vertices, size_t count, const Mat4Array& palette, Vec3* positions);
+
+  /** Returns the bounding box of the vertices skinned with the bone matrix palette. Reduced in parallel chunks. */
+  TK_API BoundingBox SkinnedBoundingBox(const class SkinVertex* vertices, size_t count, const Mat4Array& palette);
+
   TK_API bool RayMeshIntersection(const class Mesh* const mesh,
                                   const Ray& rayInWorldSpace,
                                   float& t,
@@ -110,6 +110,16 @@ namespace ToolKit
 
     TK_ASSERT_ONCE(!m_clientSideVertices.empty() || m_vertexLayout == VertexLayout::SkinMesh);
 
+    // Submeshes are culled with their own bounds, which must be known before the vertices are flushed.
+    if (!m_clientSideVertices.empty())
+    {
+      m_ownBoundingBox = BoundingBox();
+      for (const Vertex& v : m_clientSideVertices)
+      {
+        m_ownBoundingBox.UpdateBoundary(v.pos);
+      }
+    }
+
     InitVertices(flushClientSideArray);
     SetVertexLayout(m_vertexLayout);
     InitIndices(flushClientSideArray);
@@ -220,8 +230,9 @@ namespace ToolKit
       Stats::AddVRAMUsageInBytes(size);
     }
 
-    cpy->m_material    = GetMaterialManager()->Copy<Material>(m_material);
-    cpy->m_boundingBox = m_boundingBox;
+    cpy->m_material       = GetMaterialManager()->Copy<Material>(m_material);
+    cpy->m_boundingBox    = m_boundingBox;
+    cpy->m_ownBoundingBox = m_ownBoundingBox;
 
     for (MeshPtr child : m_subMeshes)
     {
@@ -245,11 +256,15 @@ namespace ToolKit
     BoundingBox aabb;
     for (Mesh* mesh : meshes)
     {
+      BoundingBox ownAABB;
       for (size_t i = 0; i < mesh->m_clientSideVertices.size(); i++)
       {
         Vertex& v = mesh->m_clientSideVertices[i];
-        aabb.UpdateBoundary(v.pos);
+        ownAABB.UpdateBoundary(v.pos);
       }
+
+      mesh->m_ownBoundingBox = ownAABB;
+      aabb.UpdateBoundary(ownAABB);
     }
     m_boundingBox = aabb;
   }
@@ -697,6 +712,11 @@ namespace ToolKit
     // CalculateBoundary() nor RayMeshIntersection() will work as expected
     m_skeleton->Init(false);
     Mesh::Init(false);
+
+    if (m_boneBounds.empty())
+    {
+      CalculateBoneBounds();
+    }
   }
 
   void SkinMesh::UnInit() { Mesh::UnInit(); }
@@ -733,6 +753,30 @@ namespace ToolKit
 
   BoundingBox SkinMesh::CalculateAABB(const Skeleton* skel, DynamicBoneMapPtr boneMap)
   {
+    if (!m_boneBounds.empty() && boneMap != nullptr)
+    {
+      // Skinned vertices are weighted blends of their bones' transforms, they stay in the union of the posed boxes.
+      BoundingBox posedAABB;
+      for (auto& [name, dBone] : boneMap->m_boneMap)
+      {
+        if (dBone.boneIndx >= m_boneBounds.size() || dBone.boneIndx >= skel->m_bones.size() ||
+            !m_boneBounds[dBone.boneIndx].IsValid())
+        {
+          continue;
+        }
+
+        StaticBone* sBone = skel->m_bones[dBone.boneIndx];
+        Mat4 boneMatrix   = dBone.node->GetTransform(TransformationSpace::TS_WORLD) * sBone->m_inverseWorldMatrix;
+
+        BoundingBox box   = m_boneBounds[dBone.boneIndx];
+        TransformAABB(box, boneMatrix);
+        posedAABB.UpdateBoundary(box.min);
+        posedAABB.UpdateBoundary(box.max);
+      }
+
+      return posedAABB;
+    }
+
     if (m_bindPoseAABBCalculated)
     {
       return m_bindPoseAABB;
@@ -742,46 +786,54 @@ namespace ToolKit
     MeshRawPtrArray meshes;
     GetAllMeshes(meshes);
 
-    std::vector<BoundingBox> AABBs(meshes.size());
-    UIntArray indexes(meshes.size());
-    for (uint i = 0; i < meshes.size(); i++)
+    Mat4Array palette;
+    CalculateSkinningPalette(skel, boneMap, false, palette);
+
+    for (Mesh* mesh : meshes)
     {
-      indexes[i] = i;
+      const std::vector<SkinVertex>& vertices = static_cast<SkinMesh*>(mesh)->m_clientSideVertices;
+      BoundingBox aabb                        = SkinnedBoundingBox(vertices.data(), vertices.size(), palette);
+      if (aabb.IsValid())
+      {
+        finalAABB.UpdateBoundary(aabb.min);
+        finalAABB.UpdateBoundary(aabb.max);
+      }
     }
 
-    std::for_each(indexes.begin(),
-                  indexes.end(),
-                  [skel, boneMap, &AABBs, &meshes](uint index)
-                  {
-                    SkinMesh* m = (SkinMesh*) meshes[index];
-                    if (m->m_clientSideVertices.empty())
-                    {
-                      return;
-                    }
-                    BoundingBox& meshAABB = AABBs[index];
-                    std::mutex meshAABBLocker;
+    m_bindPoseAABBCalculated = true;
+    m_bindPoseAABB           = finalAABB;
 
-                    std::for_each(TKExecBy(WorkerManager::FramePool),
-                                  m->m_clientSideVertices.begin(),
-                                  m->m_clientSideVertices.end(),
-                                  [skel, boneMap, &meshAABBLocker, &meshAABB](SkinVertex& v)
-                                  {
-                                    Vec3 skinnedPos = CPUSkinning(&v, skel, boneMap, false);
-                                    std::lock_guard<std::mutex> guard(meshAABBLocker);
-                                    meshAABB.UpdateBoundary(skinnedPos);
-                                  });
-                  });
+    return finalAABB;
+  }
 
-    for (BoundingBox& aabb : AABBs)
+  void SkinMesh::CalculateBoneBounds()
+  {
+    if (m_skeleton == nullptr)
     {
-      finalAABB.UpdateBoundary(aabb.max);
-      finalAABB.UpdateBoundary(aabb.min);
+      return;
     }
 
-    m_bindPoseAABBCalculated = true;
-    m_bindPoseAABB           = finalAABB;
+    m_boneBounds.clear();
+    m_boneBounds.resize(m_skeleton->m_bones.size());
 
-    return finalAABB;
+    MeshRawPtrArray meshes;
+    GetAllMeshes(meshes);
+
+    for (Mesh* mesh : meshes)
+    {
+      SkinMesh* skinMesh = static_cast<SkinMesh*>(mesh);
+      for (const SkinVertex& v : skinMesh->m_clientSideVertices)
+      {
+        for (int i = 0; i < 4; i++)
+        {
+          uint bone = (uint) v.bones[i];
+          if (v.weights[i] > 0.0f && bone < m_boneBounds.size())
+          {
+            m_boneBounds[bone].UpdateBoundary(v.pos);
+          }
+        }
+      }
+    }
   }
 
   uint SkinMesh::TotalVertexCount() const
@@ -834,8 +886,9 @@ namespace ToolKit
   void SkinMesh::CopyTo(Resource* other)
   {
     Mesh::CopyTo(other);
-    SkinMesh* cpy   = static_cast<SkinMesh*>(other);
-    cpy->m_skeleton = GetSkeletonManager()->Copy<Skeleton>(m_skeleton);
+    SkinMesh* cpy     = static_cast<SkinMesh*>(other);
+    cpy->m_skeleton   = GetSkeletonManager()->Copy<Skeleton>(m_skeleton);
+    cpy->m_boneBounds = m_boneBounds;
     cpy->m_skeleton->Init();
   }
 
@@ -136,7 +136,8 @@ namespace ToolKit
      * @brief Calculates and updates the bounding box for all meshes and submeshes.
      *
      * After calling this function, m_boundingBox will contain the updated bounds
-     * based on the vertices in the client-side array.
+     * based on the vertices in the client-side array. m_ownBoundingBox of each mesh
+     * and submesh is updated along.
      */
     void CalculateAABB();
 
@@ -245,6 +246,7 @@ namespace ToolKit
     MaterialPtr m_material;           //!< Pointer to the material used by the mesh.
     MeshPtrArray m_subMeshes;         //!< Array of pointers to submeshes.
     BoundingBox m_boundingBox;        //!< Bounding box of the mesh.
+    BoundingBox m_ownBoundingBox;     //!< Bounding box of the mesh's own vertices, submeshes excluded.
     FaceArray m_faces;                //!< Array of faces that make up the mesh.
     VertexLayout m_vertexLayout;      //!< Layout of the vertices.
 
@@ -358,6 +360,8 @@ namespace ToolKit
      * @brief Calculates the axis-aligned bounding box (AABB) based on the current pose of the skeleton.
      *
      * This function computes the AABB for the mesh as influenced by the given skeleton and bone map.
+     * The bone bounds are transformed with the posed bones, so the cost depends on the bone count, not the vertex
+     * count. Falls back to the bind pose AABB if the bone bounds are not calculated.
      * It does not alter the mesh's original bounding box (m_boundingBox).
      * @param skel Pointer to the Skeleton influencing the mesh.
      * @param boneMap Pointer to the DynamicBoneMap containing bone mapping information.
@@ -365,6 +369,13 @@ namespace ToolKit
      */
     BoundingBox CalculateAABB(const Skeleton* skel, DynamicBoneMapPtr boneMap);
 
+    /**
+     * @brief Calculates the bounds of the vertices that each bone influences.
+     *
+     * Bounds are in the bind pose, the mesh and its submeshes are accounted. Requires the client side vertices.
+     */
+    void CalculateBoneBounds();
+
    protected:
     XmlNode* DeSerializeImp(const SerializationFileInfo& info, XmlNode* parent) override;
 
@@ -389,6 +400,7 @@ namespace ToolKit
     SkeletonPtr m_skeleton;                       //!< Pointer to the skeleton associated with this mesh.
     bool m_bindPoseAABBCalculated = false;        //!< Flag indicating if the bind pose AABB has been calculated.
     BoundingBox m_bindPoseAABB;                   //!< The AABB of the mesh in its bind pose.
+    BoundingBoxArray m_boneBounds;                //!< Bind pose bounds of the vertices influenced by each bone.
   };
 
   class TK_API MeshManager : public ResourceManager
@@ -9,6 +9,7 @@
 
 #include "Entity.h"
 #include "Mesh.h"
+#include "Pass.h"
 #include "SkeletonComponent.h"
 
 namespace ToolKit
@@ -48,6 +49,12 @@ namespace ToolKit
 
   void MeshComponent::Init(bool flushClientSideArray) { GetMeshVal()->Init(flushClientSideArray); }
 
+  void MeshComponent::InvalidateRenderJobs()
+  {
+    m_renderJobsInvalidated = true;
+    m_renderJobVersion++;
+  }
+
   XmlNode* MeshComponent::SerializeImp(XmlDocument* doc, XmlNode* parent) const
   {
     XmlNode* root = Super::SerializeImp(doc, parent);
@@ -70,4 +77,17 @@ namespace ToolKit
     CastShadow_Define(true, MeshComponentCategory.Name, MeshComponentCategory.Priority, true, true);
   }
 
+  void MeshComponent::ParameterEventConstructor()
+  {
+    Super::ParameterEventConstructor();
+
+    // Bounding box and render jobs of the owner entity depend on the mesh.
+    ParamMesh().m_onValueChangedFn.push_back([this](Value& oldVal, Value& newVal) -> void
+                                             { InvalidateSpatialCaches(); });
+
+    // Shadow casting is a category of the owner entity in the aabb tree.
+    ParamCastShadow().m_onValueChangedFn.push_back([this](Value& oldVal, Value& newVal) -> void
+                                                   { InvalidateSpatialCaches(); });
+  }
+
 } // namespace ToolKit
\ No newline at end of file
@@ -9,6 +9,7 @@
 
 #include "Component.h"
 #include "GeometryTypes.h"
+#include "RenderJob.h"
 
 namespace ToolKit
 {
@@ -53,14 +54,39 @@ namespace ToolKit
      */
     void Init(bool flushClientSideArray);
 
+    /** Marks the cached render jobs for rebuild and advances the render job version. */
+    void InvalidateRenderJobs();
+
    protected:
     XmlNode* SerializeImp(XmlDocument* doc, XmlNode* parent) const override;
     void ParameterConstructor() override;
+    void ParameterEventConstructor() override;
 
    public:
     TKDeclareParam(MeshPtr, Mesh); //!< Component's Mesh resource.
     TKDeclareParam(bool, CastShadow);
 
+    /**
+     * Render jobs of the owner entity, one per sub mesh. Reused by the RenderJobProcessor across frames and passes
+     * until the owner entity's spatial caches or materials are invalidated.
+     */
+    RenderJobArray m_renderJobCache;
+    uint64 m_renderJobEnvironmentStamp = 0;    //!< Environment set that the cached jobs are assigned to. Zero if not.
+    bool m_renderJobsInvalidated       = true; //!< If true, cached render jobs are rebuilt upon access.
+
+    /**
+     * Mesh and materials of the cached render jobs, which refer to them with raw pointers. Kept alive while cached and
+     * compared to the current ones on access, so that swapped meshes and materials rebuild the jobs.
+     */
+    MeshPtr m_renderJobMesh;
+    MaterialPtrArray m_renderJobMaterials;
+
+    /**
+     * Incremented each time the cached render jobs are invalidated. Passes that keep results across frames, such as
+     * cached shadow maps, compare it to detect changes in the transform, mesh or materials of the entity.
+     */
+    uint m_renderJobVersion            = 0;
+
    private:
     BoundingBox m_boundingBox;
   };
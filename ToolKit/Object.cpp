@@ -80,15 +80,12 @@ namespace ToolKit
     HandleManager* handleMan = GetHandleManager();
     ULongID idInFile         = GetIdVal();
 
-    if (!handleMan->IsHandleUnique(idInFile))
+    // Acquire the id in the file if its unique, otherwise generate a new one.
+    if (!handleMan->AddHandle(idInFile))
     {
       _idBeforeCollision = idInFile;
       SetIdVal(handleMan->GenerateHandle());
     }
-    else
-    {
-      handleMan->AddHandle(idInFile);
-    }
   }
 
 } // namespace ToolKit
@@ -10,6 +10,7 @@
 #include "AABBOverrideComponent.h"
 #include "Camera.h"
 #include "DirectionComponent.h"
+#include "FrameArena.h"
 #include "Material.h"
 #include "MathUtil.h"
 #include "Mesh.h"
@@ -52,11 +53,219 @@ namespace ToolKit
     }
   }
 
+  /** Sort key of a job and the index of the job in the sorted range. */
+  struct JobSortItem
+  {
+    uint64 key;
+    uint index;
+  };
+
+  typedef FrameArray<JobSortItem> JobSortItemArray;
+
+  /** Maps a float to an unsigned integer that preserves the ordering of the floats. */
+  static uint SortableFloatBits(float value)
+  {
+    uint bits = glm::floatBitsToUint(value);
+    return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+  }
+
+  /**
+   * 32 bit depth key of the job that orders the jobs back to front. Perspective cameras use the squared distance to the
+   * bounding box center, orthographic cameras use the world position along z.
+   */
+  static uint64 CameraDepthKey(const RenderJobArray& jobs, const RenderJob& job, bool orthographic, const Vec3& camLoc)
+  {
+    if (orthographic)
+    {
+      return SortableFloatBits(glm::column(jobs.GetTransform(job), 3).z);
+    }
+
+    return ~SortableFloatBits(glm::length2(jobs.GetBoundingBox(job).GetCenter() - camLoc)) & 0xFFFFFFFF;
+  }
+
+  /**
+   * Stable least significant digit radix sort on 8 bit digits. Chunks of the items are counted and scattered in
+   * parallel. Digits that are the same for all keys are skipped.
+   */
+  static void RadixSort(JobSortItemArray& items)
+  {
+    constexpr int radix = 256;
+    size_t count        = items.size();
+
+    // Keys that share a digit do not need to be sorted on it.
+    uint64 keyOr        = 0;
+    uint64 keyAnd       = ~0ull;
+    for (const JobSortItem& item : items)
+    {
+      keyOr  |= item.key;
+      keyAnd &= item.key;
+    }
+    uint64 varyingBits = keyOr ^ keyAnd;
+
+    bool parallel      = count > 4096;
+    size_t chunkCount  = parallel ? glm::max(GetWorkerManager()->GetThreadCount(WorkerManager::FramePool), 1) : 1;
+    size_t chunkSize   = (count + chunkCount - 1) / chunkCount;
+
+    JobSortItemArray scratch(count, FrameArena::Get());
+    FrameArray<uint> offsets(chunkCount * radix, FrameArena::Get());
+
+    using poolstl::iota_iter;
+    for (int shift = 0; shift < 64; shift += 8)
+    {
+      if (((varyingBits >> shift) & 0xFF) == 0)
+      {
+        continue;
+      }
+
+      std::fill(offsets.begin(), offsets.end(), 0);
+      std::for_each(TKExecByConditional(parallel, WorkerManager::FramePool),
+                    iota_iter<size_t>(0),
+                    iota_iter<size_t>(chunkCount),
+                    [&](size_t chunk)
+                    {
+                      uint* histogram = &offsets[chunk * radix];
+                      size_t last     = std::min(count, (chunk + 1) * chunkSize);
+                      for (size_t i = chunk * chunkSize; i < last; i++)
+                      {
+                        histogram[(items[i].key >> shift) & 0xFF]++;
+                      }
+                    });
+
+      // Digit major prefix sum, earlier chunks write first which keeps the sort stable.
+      uint offset = 0;
+      for (int digit = 0; digit < radix; digit++)
+      {
+        for (size_t chunk = 0; chunk < chunkCount; chunk++)
+        {
+          uint& slot  = offsets[chunk * radix + digit];
+          uint digits = slot;
+          slot        = offset;
+          offset     += digits;
+        }
+      }
+
+      std::for_each(TKExecByConditional(parallel, WorkerManager::FramePool),
+                    iota_iter<size_t>(0),
+                    iota_iter<size_t>(chunkCount),
+                    [&](size_t chunk)
+                    {
+                      uint* chunkOffsets = &offsets[chunk * radix];
+                      size_t last        = std::min(count, (chunk + 1) * chunkSize);
+                      for (size_t i = chunk * chunkSize; i < last; i++)
+                      {
+                        scratch[chunkOffsets[(items[i].key >> shift) & 0xFF]++] = items[i];
+                      }
+                    });
+
+      items.swap(scratch);
+    }
+  }
+
+  /** Sorts the items and reorders the jobs starting from begin accordingly. */
+  static void SortJobsByKeys(RenderJobItr begin, JobSortItemArray& items)
+  {
+    RadixSort(items);
+
+    FrameArray<RenderJob> sorted(FrameArena::Get());
+    sorted.reserve(items.size());
+    for (const JobSortItem& item : items)
+    {
+      sorted.push_back(std::move(*(begin + item.index)));
+    }
+
+    std::move(sorted.begin(), sorted.end(), begin);
+  }
+
+  /**
+   * Returns the material that the submesh is drawn with, picked from the material component first and the mesh next.
+   * Null if neither has one.
+   */
+  static const MaterialPtr& SubMeshMaterial(const MaterialPtrArray* materialList, const Mesh* mesh, int subMeshIndx)
+  {
+    if (materialList != nullptr && subMeshIndx < (int) materialList->size() && (*materialList)[subMeshIndx] != nullptr)
+    {
+      return (*materialList)[subMeshIndx];
+    }
+
+    return mesh->m_material;
+  }
+
+  /**
+   * Checks if the cached jobs still refer to the meshes and materials that the entity is drawn with. Meshes and
+   * materials can be swapped or reloaded without invalidating the entity.
+   */
+  static bool CachedJobsMatch(Entity* ntt, const MeshComponent* meshComp, const MeshRawPtrArray& allMeshes)
+  {
+    const RenderJobArray& cache = meshComp->m_renderJobCache;
+    if (cache.size() != allMeshes.size() || meshComp->m_renderJobMesh != meshComp->GetMeshVal())
+    {
+      return false;
+    }
+
+    const MaterialPtrArray* materialList = nullptr;
+    if (const MaterialComponent* matComp = ntt->GetComponentFast<MaterialComponent>())
+    {
+      materialList = &matComp->GetMaterialList();
+    }
+
+    for (int subMeshIndx = 0; subMeshIndx < (int) allMeshes.size(); subMeshIndx++)
+    {
+      const RenderJob& job = cache[subMeshIndx];
+      if (job.Mesh != allMeshes[subMeshIndx])
+      {
+        return false;
+      }
+
+      // Cached material is the default one, if the submesh doesn't have any.
+      const MaterialPtr& material = SubMeshMaterial(materialList, allMeshes[subMeshIndx], subMeshIndx);
+      if (material != nullptr ? job.Material != material.get()
+                              : job.Material != meshComp->m_renderJobMaterials[subMeshIndx].get())
+      {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  /**
+   * Hashes the state of the environments that the job assignments depend on.
+   * @returns Zero if there is nothing to assign.
+   */
+  static uint64 EnvironmentSetStamp(const EnvironmentComponentPtrArray& environments)
+  {
+    if (environments.empty())
+    {
+      return 0;
+    }
+
+    uint64 stamp   = 0;
+    auto combineFn = [&stamp](uint64 value) -> void { stamp ^= value + 0x9e3779b9 + (stamp << 6) + (stamp >> 2); };
+    auto combineFloatsFn = [&combineFn](const float* values, int count) -> void
+    {
+      for (int i = 0; i < count; i++)
+      {
+        combineFn(std::hash<float>()(values[i]));
+      }
+    };
+
+    for (const EnvironmentComponentPtr& volume : environments)
+    {
+      combineFn((uint64) volume.get());
+      combineFn((uint64) volume->GetIlluminateVal());
+
+      const BoundingBox& box = volume->GetBoundingBox();
+      combineFloatsFn(&box.min.x, 3);
+      combineFloatsFn(&box.max.x, 3);
+    }
+
+    // Zero is reserved for the unassigned jobs.
+    return stamp == 0 ? 1 : stamp;
+  }
+
   void RenderJobProcessor::CreateRenderJobs(RenderJobArray& jobArray,
                                             EntityRawPtrArray& entities,
                                             bool ignoreVisibility,
-                                            int dirLightEndIndex,
-                                            const LightRawPtrArray& lights,
                                             const EnvironmentComponentPtrArray& environments)
   {
     // Each entity can contain several meshes. This submeshIndexLookup array will be used
@@ -64,7 +273,7 @@ namespace ToolKit
     // Ex: Entity index is 4 and it has 3 submesh,
     // its submesh indexes would be = {4, 5, 6}
     // to look them up: {nttIndex + 0, nttIndex + 1, nttIndex + 3} formula is used.
-    IntArray submeshIndexLookup;
+    FrameArray<int> submeshIndexLookup(FrameArena::Get());
     int size = 0;
 
     // Apply ntt visibility check.
@@ -85,14 +294,81 @@ namespace ToolKit
                return true;
              });
 
-    jobArray.clear();
-    jobArray.resize(size); // at least.
+    // Jobs are overwritten by the cached ones.
+    jobArray.resize(size);
 
     if (entities.empty())
     {
       return;
     }
 
+    uint64 environmentStamp = EnvironmentSetStamp(environments);
+
+    // Rebuilds the cached jobs of the entity. Environments are assigned separately.
+    auto buildCacheFn = [](Entity* ntt, MeshComponent* meshComp) -> void
+    {
+      const MaterialPtrArray* materialList = nullptr;
+      if (const MaterialComponent* matComp = ntt->GetComponentFast<MaterialComponent>())
+      {
+        materialList = &matComp->GetMaterialList();
+      }
+
+      // Mesh is initialized while filtering the entities, its submesh list is up to date.
+      const MeshRawPtrArray& allMeshes = meshComp->GetMeshVal()->GetAllMeshes();
+
+      // Each job of the cache indexes its own slot in the side tables.
+      RenderJobArray& cache = meshComp->m_renderJobCache;
+      cache.clear();
+      cache.resize(allMeshes.size());
+
+      // Jobs refer to the meshes and materials with raw pointers, keep them alive while they are cached.
+      meshComp->m_renderJobMesh = meshComp->GetMeshVal();
+      meshComp->m_renderJobMaterials.resize(allMeshes.size());
+
+      bool cullFlip      = ntt->m_node->RequireCullFlip();
+      Mat4 transform     = ntt->m_node->GetTransform();
+      BoundingBox bounds = ntt->GetBoundingBox(true);
+
+      // Submeshes are bound by their own boxes, unless the entity's box is overridden or deformed by skinning.
+      bool subMeshBounds = allMeshes.size() > 1 && !allMeshes.front()->IsSkinned() &&
+                           ntt->GetComponentFast<AABBOverrideComponent>() == nullptr;
+      for (int subMeshIndx = 0; subMeshIndx < (int) allMeshes.size(); subMeshIndx++)
+      {
+        Mesh* mesh           = allMeshes[subMeshIndx];
+        MaterialPtr material = SubMeshMaterial(materialList, mesh, subMeshIndx);
+
+        // Worst case, no material found pick a copy of default.
+        if (material == nullptr)
+        {
+          material = GetMaterialManager()->GetDefaultMaterial();
+          TK_WRN("Material component for entity: \"%s\" has less material than mesh count. Default "
+                 "material used for meshes with missing material.",
+                 ntt->GetNameVal().c_str());
+        }
+
+        RenderJob& job            = cache[subMeshIndx];
+        job.Entity                = ntt;
+        job.Mesh                  = mesh;
+        job.Material              = material.get();
+        job.requireCullFlip       = cullFlip;
+        job.ShadowCaster          = meshComp->GetCastShadowVal();
+        cache.GetTransform(job)   = transform;
+        cache.GetBoundingBox(job) = bounds;
+
+        if (subMeshBounds && mesh->m_ownBoundingBox.IsValid())
+        {
+          BoundingBox& box = cache.GetBoundingBox(job);
+          box              = mesh->m_ownBoundingBox;
+          TransformAABB(box, transform);
+        }
+
+        meshComp->m_renderJobMaterials[subMeshIndx] = material;
+      }
+
+      meshComp->m_renderJobEnvironmentStamp = 0;
+      meshComp->m_renderJobsInvalidated     = false;
+    };
+
     // Construct jobs.
     using poolstl::iota_iter;
     std::for_each(TKExecByConditional(entities.size() > 1000, WorkerManager::FramePool),
@@ -100,74 +376,58 @@ namespace ToolKit
                   iota_iter<size_t>(entities.size()),
                   [&](size_t nttIndex)
                   {
-                    Entity* ntt                    = entities[nttIndex];
-                    MaterialPtrArray* materialList = nullptr;
-                    if (MaterialComponent* matComp = ntt->GetComponentFast<MaterialComponent>())
+                    Entity* ntt             = entities[nttIndex];
+                    MeshComponent* meshComp = ntt->GetComponentFast<MeshComponent>();
+                    RenderJobArray& cache   = meshComp->m_renderJobCache;
+
+                    const MeshRawPtrArray& allMeshes = meshComp->GetMeshVal()->GetAllMeshes();
+                    int jobCount                     = (int) allMeshes.size();
+                    if (meshComp->m_renderJobsInvalidated)
                     {
-                      materialList = &matComp->GetMaterialList();
+                      buildCacheFn(ntt, meshComp);
                     }
-
-                    MeshComponent* meshComp   = ntt->GetComponentFast<MeshComponent>();
-                    const MeshPtr& parentMesh = meshComp->GetMeshVal();
-
-                    MeshRawPtrArray allMeshes;
-                    parentMesh->GetAllMeshes(allMeshes);
-
-                    bool cullFlip  = ntt->m_node->RequireCullFlip();
-                    Mat4 transform = ntt->m_node->GetTransform();
-                    for (int subMeshIndx = 0; subMeshIndx < (int) allMeshes.size(); subMeshIndx++)
+                    else if (!CachedJobsMatch(ntt, meshComp, allMeshes))
                     {
-                      Mesh* mesh           = allMeshes[subMeshIndx];
-                      MaterialPtr material = nullptr;
-
-                      // Pick the material for submesh.
-                      if (materialList != nullptr)
-                      {
-                        if (subMeshIndx < materialList->size())
-                        {
-                          material = (*materialList)[subMeshIndx];
-                        }
-                      }
-
-                      // if material is still null, pick from mesh.
-                      if (material == nullptr)
-                      {
-                        if (mesh->m_material)
-                        {
-                          material = mesh->m_material;
-                        }
-                      }
+                      // Mesh or materials are changed without invalidating the entity, notify the dependent passes.
+                      meshComp->m_renderJobVersion++;
+                      buildCacheFn(ntt, meshComp);
+                    }
 
-                      // Worst case, no material found pick a copy of default.
-                      if (material == nullptr)
+                    // Assign environments, if the cached ones are assigned to a different set.
+                    if (environmentStamp != 0 && meshComp->m_renderJobEnvironmentStamp != environmentStamp)
+                    {
+                      for (RenderJob& job : cache)
                       {
-                        material = GetMaterialManager()->GetDefaultMaterial();
-                        TK_WRN("Material component for entity: \"%s\" has less material than mesh count. Default "
-                               "material used for meshes with missing material.",
-                               ntt->GetNameVal().c_str());
+                        AssignEnvironment(job, cache.GetBoundingBox(job), environments);
                       }
 
-                      // Translate nttIndex to corresponding job index.
-                      int jobIndex        = submeshIndexLookup[nttIndex] + subMeshIndx;
+                      meshComp->m_renderJobEnvironmentStamp = environmentStamp;
+                    }
 
-                      RenderJob& job      = jobArray[jobIndex];
-                      job.Entity          = ntt;
-                      job.Mesh            = mesh;
-                      job.Material        = material.get();
-                      job.requireCullFlip = cullFlip;
-                      job.ShadowCaster    = meshComp->GetCastShadowVal();
-                      job.WorldTransform  = ntt->m_node->GetTransform();
-                      job.BoundingBox     = ntt->GetBoundingBox(true);
+                    // Animation data is referenced, it stays valid until the frame is rendered.
+                    const AnimData* animData = nullptr;
+                    if (SkeletonComponent* skComp = ntt->GetComponentFast<SkeletonComponent>())
+                    {
+                      animData = &skComp->GetAnimData();
+                    }
 
-                      // Assign skeletal animations.
-                      if (SkeletonComponent* skComp = ntt->GetComponentFast<SkeletonComponent>())
+                    for (int subMeshIndx = 0; subMeshIndx < jobCount; subMeshIndx++)
+                    {
+                      // Translate nttIndex to corresponding job index. Jobs index their own slots in the side tables.
+                      uint jobIndex                      = (uint) (submeshIndexLookup[nttIndex] + subMeshIndx);
+                      const RenderJob& cachedJob         = cache[subMeshIndx];
+
+                      RenderJob& job                     = jobArray[jobIndex];
+                      job                                = cachedJob;
+                      job.transformIndex                 = jobIndex;
+                      jobArray.m_transforms[jobIndex]    = cache.GetTransform(cachedJob);
+                      jobArray.m_boundingBoxes[jobIndex] = cache.GetBoundingBox(cachedJob);
+                      jobArray.m_animData[jobIndex]      = animData;
+
+                      if (environmentStamp == 0)
                       {
-                        job.animData = skComp->GetAnimData(); // copy
+                        job.EnvironmentVolume = nullptr;
                       }
-
-                      // push directional lights.
-                      AssignLight(job, lights, dirLightEndIndex);
-                      AssignEnvironment(job, environments);
                     }
                   });
   }
@@ -181,7 +441,9 @@ namespace ToolKit
   void RenderJobProcessor::SeperateRenderData(RenderData& renderData, bool forwardOnly)
   {
     // Group culled.
-    RenderJobItr beginItr   = renderData.jobs.begin();
+    RenderJobItr beginItr   = std::partition(renderData.jobs.begin(),
+                                           renderData.jobs.end(),
+                                           [](const RenderJob& job) { return job.frustumCulled; });
     RenderJobItr forwardItr = beginItr;
     RenderJobItr translucentItr;
     RenderJobItr deferredAlphaMaskedItr;
@@ -224,39 +486,37 @@ namespace ToolKit
     renderData.forwardTranslucentStartIndex     = (int) std::distance(renderData.jobs.begin(), translucentItr);
   }
 
-  void RenderJobProcessor::AssignLight(RenderJob& job, const LightRawPtrArray& lights, int startIndex)
+  void RenderJobProcessor::CullRenderJobs(RenderJobArray& jobs, const Frustum& frustum)
   {
-    // Add all directional lights.
-    for (int i = 0; i < startIndex; i++)
-    {
-      job.lights.push_back(lights[i]);
-      if (i >= RHIConstants::MaxLightsPerObject)
-      {
-        break;
-      }
-    }
+    using poolstl::iota_iter;
+    std::for_each(TKExecByConditional(jobs.size() > 1000, WorkerManager::FramePool),
+                  iota_iter<size_t>(0),
+                  iota_iter<size_t>(jobs.size()),
+                  [&](size_t jobIndex)
+                  {
+                    RenderJob& job         = jobs[jobIndex];
+                    IntersectResult result = FrustumBoxIntersection(frustum, jobs.GetBoundingBox(job));
+                    job.frustumCulled      = result == IntersectResult::Outside;
+                  });
+  }
 
-    // No more lights to assign.
-    if (lights.size() == job.lights.size())
-    {
-      // Possibly editor lighting. All directional lights assigned to job.
-      return;
-    }
+  void RenderJobProcessor::CollectLights(const BoundingBox& box,
+                                         const LightRawPtrArray& lights,
+                                         int startIndex,
+                                         LightRawPtrArray& affectingLights)
+  {
+    // Add all directional lights.
+    affectingLights.insert(affectingLights.end(), lights.begin(), lights.begin() + startIndex);
 
     for (size_t i = startIndex; i < lights.size(); i++)
     {
       Light* light = lights[i];
-      if (job.lights.size() >= RHIConstants::MaxLightsPerObject)
-      {
-        return;
-      }
-
       if (light->GetLightType() == Light::LightType::Spot)
       {
         SpotLight* spot = static_cast<SpotLight*>(light);
-        if (FrustumBoxIntersection(spot->m_frustumCache, job.BoundingBox) != IntersectResult::Outside)
+        if (FrustumBoxIntersection(spot->m_frustumCache, box) != IntersectResult::Outside)
         {
-          job.lights.push_back(light);
+          affectingLights.push_back(light);
         }
       }
       else
@@ -265,9 +525,9 @@ namespace ToolKit
         // lights must be presorted, check it.
         assert(light->IsA<PointLight>());
         PointLight* point = static_cast<PointLight*>(light);
-        if (SphereBoxIntersection(point->m_boundingSphereCache, job.BoundingBox))
+        if (SphereBoxIntersection(point->m_boundingSphereCache, box))
         {
-          job.lights.push_back(light);
+          affectingLights.push_back(light);
         }
       }
     }
@@ -283,72 +543,165 @@ namespace ToolKit
     return (int) std::distance(lights.begin(), dirEndItr);
   }
 
-  void RenderJobProcessor::SortByDistanceToCamera(RenderJobItr begin, RenderJobItr end, const CameraPtr& cam)
+  void RenderJobProcessor::SortByDistanceToCamera(const RenderJobArray& jobs,
+                                                  RenderJobItr begin,
+                                                  RenderJobItr end,
+                                                  const CameraPtr& cam)
+  {
+    bool orthographic = cam->IsOrtographic();
+    Vec3 camLoc       = cam->m_node->GetTranslation(TransformationSpace::TS_WORLD);
+
+    JobSortItemArray items(FrameArena::Get());
+    items.reserve(std::distance(begin, end));
+
+    uint index = 0;
+    for (RenderJobItr job = begin; job != end; job++)
+    {
+      items.push_back({CameraDepthKey(jobs, *job, orthographic, camLoc), index++});
+    }
+
+    SortJobsByKeys(begin, items);
+  }
+
+  void RenderJobProcessor::SortByMaterial(RenderData& renderData, const CameraPtr& cam)
   {
-    Vec3 camLoc = cam->m_node->GetTranslation(TransformationSpace::TS_WORLD);
+    // Partitions in order, culled jobs are left as they are.
+    int bucketStarts[] = {renderData.deferredJobsStartIndex,
+                          renderData.deferredAlphaMaskedJobsStartIndex,
+                          renderData.forwardOpaqueStartIndex,
+                          renderData.forwardAlphaMaskedJobsStartIndex,
+                          renderData.forwardTranslucentStartIndex,
+                          (int) renderData.jobs.size()};
+
+    int firstBucket     = renderData.deferredJobsStartIndex != -1 ? 0 : 2;
+    int translucentIndx = 4;
+
+    bool hasDepth       = cam != nullptr;
+    bool orthographic   = hasDepth && cam->IsOrtographic();
+    Vec3 camLoc         = hasDepth ? cam->m_node->GetTranslation(TransformationSpace::TS_WORLD) : Vec3(0.0f);
+
+    // Ids don't fit in the key, materials are packed by their rank among the materials of the frame instead.
+    FrameArray<Material*> materials(FrameArena::Get());
+    materials.reserve(renderData.jobs.size() - bucketStarts[firstBucket]);
+    for (int i = bucketStarts[firstBucket]; i < (int) renderData.jobs.size(); i++)
+    {
+      materials.push_back(renderData.jobs[i].Material);
+    }
+
+    auto idOrderFn = [](const Material* a, const Material* b) -> bool
+    { return a->GetIdVal() < b->GetIdVal() || (a->GetIdVal() == b->GetIdVal() && a < b); };
+
+    std::sort(materials.begin(), materials.end(), idOrderFn);
+    materials.erase(std::unique(materials.begin(), materials.end()), materials.end());
 
-    std::function<bool(const RenderJob&, const RenderJob&)> sortFn = [&camLoc](const RenderJob& j1,
-                                                                               const RenderJob& j2) -> bool
+    auto materialIndexFn = [&](Material* mat) -> uint64
+    { return std::lower_bound(materials.begin(), materials.end(), mat, idOrderFn) - materials.begin(); };
+
+    // Opaque key:      bucket 3 | program 10 | material 20 | mesh 16 | depth 15, front to back.
+    // Translucent key: bucket 3 | depth 32, back to front | material 29.
+    auto opaqueKeyFn = [&](const RenderJob& job, uint64 bucket) -> uint64
     {
-      const BoundingBox& bb1 = j1.BoundingBox;
-      const BoundingBox& bb2 = j2.BoundingBox;
+      Material* mat  = job.Material;
+      uint64 program = 0;
+      if (mat->IsShaderMaterial())
+      {
+        uint64 shaders = (uint64) mat->m_vertexShader.get() ^ ((uint64) mat->m_fragmentShader.get() >> 4);
+        program        = 1 + (std::hash<uint64>()(shaders) % 1023);
+      }
 
-      float first            = glm::length2(bb1.GetCenter() - camLoc);
-      float second           = glm::length2(bb2.GetCenter() - camLoc);
+      uint64 material = std::min<uint64>(materialIndexFn(mat), 0xFFFFF);
+      uint64 mesh     = job.Mesh->m_vaoId & 0xFFFF;
+      uint64 depth    = hasDepth ? (~CameraDepthKey(renderData.jobs, job, orthographic, camLoc) & 0xFFFFFFFF) >> 17 : 0;
 
-      return second < first;
+      return (bucket << 61) | (program << 51) | (material << 31) | (mesh << 15) | depth;
     };
 
-    if (cam->IsOrtographic())
+    auto translucentKeyFn = [&](const RenderJob& job, uint64 bucket) -> uint64
     {
-      sortFn = [cam](const RenderJob& j1, const RenderJob& j2) -> bool
+      uint64 depth    = hasDepth ? CameraDepthKey(renderData.jobs, job, orthographic, camLoc) : 0;
+      uint64 material = std::min<uint64>(materialIndexFn(job.Material), 0x1FFFFFFF);
+
+      return (bucket << 61) | (depth << 29) | material;
+    };
+
+    int begin = bucketStarts[firstBucket];
+    JobSortItemArray items(FrameArena::Get());
+    items.reserve(renderData.jobs.size() - begin);
+
+    for (int bucket = firstBucket; bucket < translucentIndx + 1; bucket++)
+    {
+      for (int i = bucketStarts[bucket]; i < bucketStarts[bucket + 1]; i++)
       {
-        float first  = glm::column(j1.WorldTransform, 3).z;
-        float second = glm::column(j2.WorldTransform, 3).z;
-        return first < second;
-      };
+        const RenderJob& job = renderData.jobs[i];
+        uint64 key           = bucket == translucentIndx ? translucentKeyFn(job, bucket) : opaqueKeyFn(job, bucket);
+        items.push_back({key, (uint) (i - begin)});
+      }
     }
 
-    std::sort(begin, end, sortFn);
+    // Buckets keep the partitions in place, a single sort covers all of them.
+    SortJobsByKeys(renderData.jobs.begin() + begin, items);
   }
 
-  void RenderJobProcessor::SortByMaterial(RenderData& renderData)
+  void RenderJobProcessor::BatchInstances(RenderData& renderData)
   {
-    auto sortRangeFn = [](RenderJobItr begin, RenderJobItr end) -> void
+    // Batches gather their transforms consecutively from the job array's transform table.
+    RenderJobArray& jobs = renderData.jobs;
+    jobs.m_instanceTransforms.clear();
+
+    auto sameBatchFn = [](const RenderJob& a, const RenderJob& b) -> bool
     {
-      std::sort(begin,
-                end,
-                [](const RenderJob& a, const RenderJob& b) -> bool
-                { return a.Material->GetIdVal() < b.Material->GetIdVal(); });
+      return a.Mesh == b.Mesh && a.Material == b.Material && a.EnvironmentVolume == b.EnvironmentVolume &&
+             a.requireCullFlip == b.requireCullFlip;
     };
 
-    RenderJobItr begin, end;
-
-    if (renderData.deferredJobsStartIndex != -1)
+    auto batchRangeFn = [&](RenderJobItr begin, RenderJobItr end) -> void
     {
-      begin = renderData.GetDefferedBegin();
-      end   = renderData.GetDeferredAlphaMaskedBegin();
-      sortRangeFn(begin, end);
-
-      begin = renderData.GetDeferredAlphaMaskedBegin();
-      end   = renderData.GetForwardOpaqueBegin();
-      sortRangeFn(begin, end);
-    }
+      RenderJobItr batchBegin = begin;
+      while (batchBegin != end)
+      {
+        RenderJobItr batchEnd = batchBegin + 1;
+        if (!batchBegin->Mesh->IsSkinned() && !batchBegin->Material->IsShaderMaterial())
+        {
+          while (batchEnd != end && sameBatchFn(*batchBegin, *batchEnd))
+          {
+            batchEnd++;
+          }
+        }
 
-    begin = renderData.GetForwardOpaqueBegin();
-    end   = renderData.GetForwardAlphaMaskedBegin();
-    sortRangeFn(begin, end);
+        int count = (int) std::distance(batchBegin, batchEnd);
+        if (count > 1)
+        {
+          batchBegin->instanceCount  = count;
+          batchBegin->instanceOffset = (uint) jobs.m_instanceTransforms.size();
+
+          for (RenderJobItr job = batchBegin; job != batchEnd; job++)
+          {
+            const Mat4& model = jobs.GetTransform(*job);
+            jobs.m_instanceTransforms.push_back({model, glm::transpose(glm::inverse(Mat3(model)))});
+            if (job != batchBegin)
+            {
+              job->instanceCount  = 0;
+              job->instanceOffset = 0;
+            }
+          }
+        }
+        else
+        {
+          batchBegin->instanceCount  = 1;
+          batchBegin->instanceOffset = 0;
+        }
 
-    begin = renderData.GetForwardAlphaMaskedBegin();
-    end   = renderData.GetForwardTranslucentBegin();
-    sortRangeFn(begin, end);
+        batchBegin = batchEnd;
+      }
+    };
 
-    begin = renderData.GetForwardTranslucentBegin();
-    end   = renderData.jobs.end();
-    sortRangeFn(begin, end);
+    batchRangeFn(renderData.GetForwardOpaqueBegin(), renderData.GetForwardAlphaMaskedBegin());
+    batchRangeFn(renderData.GetForwardAlphaMaskedBegin(), renderData.GetForwardTranslucentBegin());
   }
 
-  void RenderJobProcessor::AssignEnvironment(RenderJob& job, const EnvironmentComponentPtrArray& environments)
+  void RenderJobProcessor::AssignEnvironment(RenderJob& job,
+                                             const BoundingBox& box,
+                                             const EnvironmentComponentPtrArray& environments)
   {
     BoundingBox bestBox;
     job.EnvironmentVolume = nullptr;
@@ -361,7 +714,7 @@ namespace ToolKit
 
       // Pick the smallest volume intersecting with job.
       const BoundingBox& vbb = volume->GetBoundingBox();
-      if (BoxBoxIntersection(vbb, job.BoundingBox) != IntersectResult::Outside)
+      if (BoxBoxIntersection(vbb, box) != IntersectResult::Outside)
       {
         if (bestBox.Volume() > vbb.Volume() || job.EnvironmentVolume == nullptr)
         {
@@ -380,7 +733,7 @@ namespace ToolKit
     Vec3 sum(0.0f);
     for (int i = 0; i < n; i++)
     {
-      Vec3 pos  = rjVec[i].WorldTransform[3];
+      Vec3 pos  = rjVec.GetTransform(rjVec[i])[3];
       sum      += pos;
     }
     mean      = sum / (float) n;
@@ -389,16 +742,20 @@ namespace ToolKit
     float ssd = 0.0f;
     for (int i = 0; i < n; i++)
     {
-      Vec3 pos   = rjVec[i].WorldTransform[3];
+      Vec3 pos   = rjVec.GetTransform(rjVec[i])[3];
       Vec3 diff  = pos - mean;
       ssd       += glm::dot(diff, diff);
     }
     stdev = std::sqrt(ssd / (float) n);
   }
 
-  bool RenderJobProcessor::IsOutlier(const RenderJob& rj, float sigma, const float stdev, const Vec3& mean)
+  bool RenderJobProcessor::IsOutlier(const RenderJobArray& rjVec,
+                                     const RenderJob& rj,
+                                     float sigma,
+                                     const float stdev,
+                                     const Vec3& mean)
   {
-    Vec3 pos   = rj.WorldTransform[3];
+    Vec3 pos   = rjVec.GetTransform(rj)[3];
     Vec3 diff  = pos - mean;
     float dist = glm::length(diff) / stdev;
 
@@ -8,6 +8,7 @@
 #pragma once
 
 #include "EnvironmentComponent.h"
+#include "RenderJob.h"
 #include "Renderer.h"
 
 namespace ToolKit
@@ -42,24 +43,6 @@ namespace ToolKit
     Renderer* m_renderer = nullptr;
   };
 
-  /** This struct holds all the data required to make a drawcall. */
-  struct RenderJob
-  {
-    Entity* Entity                          = nullptr; //!< Entity that this job is created from.
-    Mesh* Mesh                              = nullptr; //!< Mesh to render.
-    Material* Material                      = nullptr; //!< Material to render job with.
-    EnvironmentComponent* EnvironmentVolume = nullptr; //!< EnvironmentVolume effecting this entity, if any.
-    bool ShadowCaster                       = true;    //!< Account in shadow map construction.
-    bool frustumCulled                      = false;   //!< States that the job is culled by a camera.
-    bool requireCullFlip                    = false;   //!< Negative determinant in transform requires cull side flip.
-
-    BoundingBox BoundingBox; //!< World space bounding box.
-    Mat4 WorldTransform;     //!< World transform of the entity.
-    AnimData animData;       //!< Animation data of render job.
-
-    LightRawPtrArray lights;
-  };
-
   typedef RenderJobArray::iterator RenderJobItr;
 
   /**
@@ -102,18 +85,17 @@ namespace ToolKit
   {
    public:
     /**
-     * Constructs all render jobs from entities.
+     * Constructs all render jobs from entities. Jobs are cached in the entities' MeshComponent and only rebuilt when
+     * the entity invalidates its spatial caches or materials. Environments are reassigned when they change.
+     * Jobs don't carry lights, lit passes fetch them from a LightGrid.
      * @param jobArray is the array of constructed jobs.
      * @param entities are the entities to construct render jobs for.
-     * @param lights are the list of lights to consider. Lights must be presorted before sending them to this function.
-     * @param environments are the environment volumes to consider.
      * @param ingnoreVisibility when set true, construct jobs for entities that has visibility set to false.
+     * @param environments are the environment volumes to consider.
      */
     static void CreateRenderJobs(RenderJobArray& jobArray,
                                  EntityRawPtrArray& entities,
                                  bool ignoreVisibility                            = false,
-                                 int dirLightEndIndex                             = 0,
-                                 const LightRawPtrArray& lights                   = {},
                                  const EnvironmentComponentPtrArray& environments = {});
 
     static void CreateRenderJobs(RenderJobArray& jobArray, EntityPtr entity);
@@ -126,11 +108,32 @@ namespace ToolKit
      */
     static void SeperateRenderData(RenderData& renderData, bool forwardOnly);
 
-    /** Assign all lights affecting the job. */
-    static void AssignLight(RenderJob& job, const LightRawPtrArray& lights, int startIndex);
+    /**
+     * Marks the jobs whose bounding box is outside of the frustum as culled. Entities are culled as a whole before
+     * their jobs are created, this rejects the individual submeshes of the visible entities.
+     * SeperateRenderData() moves the culled jobs to the beginning of the array.
+     */
+    static void CullRenderJobs(RenderJobArray& jobs, const Frustum& frustum);
 
-    /** Assign environment to each job. If job is under influence of many environment, picks the smallest volume. */
-    static void AssignEnvironment(RenderJob& job, const EnvironmentComponentPtrArray& environments);
+    /**
+     * Collects all lights affecting the given bounding box.
+     * @param box is the world space bounding box to test the lights against.
+     * @param lights are the lights to consider. Lights must be presorted.
+     * @param startIndex is the index where the non directional lights starts.
+     * @param affectingLights is the array that the affecting lights are appended to.
+     */
+    static void CollectLights(const BoundingBox& box,
+                              const LightRawPtrArray& lights,
+                              int startIndex,
+                              LightRawPtrArray& affectingLights);
+
+    /**
+     * Assign environment to the job with the given bounding box. If job is under influence of many environment, picks
+     * the smallest volume.
+     */
+    static void AssignEnvironment(RenderJob& job,
+                                  const BoundingBox& box,
+                                  const EnvironmentComponentPtrArray& environments);
 
     /**
      * Makes sure that first elements are directional lights.
@@ -139,11 +142,25 @@ namespace ToolKit
      */
     static int PreSortLights(LightRawPtrArray& lights);
 
-    /** Sort entities by distance(from boundary center) in ascending order to camera. Accounts for isometric camera. */
-    static void SortByDistanceToCamera(RenderJobItr begin, RenderJobItr end, const CameraPtr& cam);
+    /** Sort entities by distance(from boundary center) in descending order to camera. Accounts for isometric camera. */
+    static void SortByDistanceToCamera(const RenderJobArray& jobs,
+                                       RenderJobItr begin,
+                                       RenderJobItr end,
+                                       const CameraPtr& cam);
+
+    /**
+     * Sort render jobs in each partition with a packed 64 bit key. Opaque and alpha masked jobs are ordered by gpu
+     * program, material, mesh and front to back depth. Translucent jobs are ordered back to front.
+     * @param cam is the camera to calculate depths with. If null, depth is not accounted.
+     */
+    static void SortByMaterial(RenderData& renderData, const CameraPtr& cam = nullptr);
 
-    /** Sort render jobs based on materials. */
-    static void SortByMaterial(RenderData& renderData);
+    /**
+     * Merges consecutive forward opaque and alpha masked jobs that share the same mesh, material and environment
+     * into instance batches. Skinned meshes and shader materials are not batched.
+     * Must be called after SortByMaterial.
+     */
+    static void BatchInstances(RenderData& renderData);
 
     /**
      * Calculates the standard deviation and mean of the given RenderJobArray
@@ -156,10 +173,15 @@ namespace ToolKit
 
     /**
      * Decides if the given RenderJob is an outlier based on its world position.
+     * @param rjVec is the array that the job belongs to.
      * @param rj is the RenderJob to decide if its outlier.
      * @param sigma is the threshold sigma to accept as outlier or not.
      */
-    static bool IsOutlier(const RenderJob& rj, float sigma, const float stdev, const Vec3& mean);
+    static bool IsOutlier(const RenderJobArray& rjVec,
+                          const RenderJob& rj,
+                          float sigma,
+                          const float stdev,
+                          const Vec3& mean);
   };
 
 } // namespace ToolKit
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2019-2024 OtSofware
+ * This code is licensed under the GNU Lesser General Public License v3.0 (LGPL-3.0).
+ * For more information, including options for a more permissive commercial license,
+ * please visit [otyazilim.com] or contact us at [info@otyazilim.com].
+ */
+
+#include "RenderJob.h"
+
+namespace ToolKit
+{
+
+  void RenderJobArray::clear()
+  {
+    m_jobs.clear();
+    m_transforms.clear();
+    m_boundingBoxes.clear();
+    m_animData.clear();
+    m_instanceTransforms.clear();
+  }
+
+  void RenderJobArray::reserve(size_t count)
+  {
+    m_jobs.reserve(count);
+    m_transforms.reserve(count);
+    m_boundingBoxes.reserve(count);
+    m_animData.reserve(count);
+  }
+
+  void RenderJobArray::resize(size_t count)
+  {
+    size_t oldCount = m_jobs.size();
+
+    m_jobs.resize(count);
+    m_transforms.resize(count, Mat4(1.0f));
+    m_boundingBoxes.resize(count);
+    m_animData.resize(count, nullptr);
+
+    for (size_t i = oldCount; i < count; i++)
+    {
+      m_jobs[i].transformIndex = (uint) i;
+    }
+  }
+
+  RenderJob& RenderJobArray::Add(const RenderJobArray& source, const RenderJob& job)
+  {
+    RenderJob& added     = m_jobs.emplace_back(job);
+    added.transformIndex = (uint) m_transforms.size();
+
+    m_transforms.push_back(source.GetTransform(job));
+    m_boundingBoxes.push_back(source.GetBoundingBox(job));
+    m_animData.push_back(source.GetAnimData(job));
+
+    // Instance batches are not carried over, the job is drawn alone.
+    if (job.instanceCount != 1)
+    {
+      added.instanceCount  = 1;
+      added.instanceOffset = 0;
+    }
+
+    return added;
+  }
+
+  void RenderJobArray::Append(const RenderJobArray& other)
+  {
+    reserve(size() + other.size());
+    for (const RenderJob& job : other)
+    {
+      Add(other, job);
+    }
+  }
+
+} // namespace ToolKit
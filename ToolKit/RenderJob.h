@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2019-2024 OtSofware
+ * This code is licensed under the GNU Lesser General Public License v3.0 (LGPL-3.0).
+ * For more information, including options for a more permissive commercial license,
+ * please visit [otyazilim.com] or contact us at [info@otyazilim.com].
+ */
+
+#pragma once
+
+#include "GeometryTypes.h"
+
+namespace ToolKit
+{
+
+  class EnvironmentComponent;
+  struct AnimData;
+
+  /**
+   * This struct holds the data required to sort, cull and batch a drawcall. It is kept small and trivially copyable,
+   * jobs are moved around by partitioning and sorting every frame. Data that is only needed to draw the job lives in
+   * the side tables of the RenderJobArray that the job belongs to.
+   */
+  struct RenderJob
+  {
+    Entity* Entity                          = nullptr; //!< Entity that this job is created from.
+    Mesh* Mesh                              = nullptr; //!< Mesh to render.
+    Material* Material                      = nullptr; //!< Material to render job with.
+    EnvironmentComponent* EnvironmentVolume = nullptr; //!< EnvironmentVolume effecting this entity, if any.
+
+    /** Index of the job's transform, bounding box and animation data in the side tables. */
+    uint transformIndex                     = 0;
+
+    /**
+     * Number of instances drawn with this job. Greater than one for the first job of an instance batch, zero for the
+     * rest of the batch which are drawn by the first job.
+     */
+    int instanceCount                       = 1;
+    uint instanceOffset                     = 0; //!< First transform of the batch in the instance transforms.
+
+    bool ShadowCaster                       = true;  //!< Account in shadow map construction.
+    bool frustumCulled                      = false; //!< States that the job is culled by a camera.
+    bool requireCullFlip                    = false; //!< Negative determinant in transform requires cull side flip.
+  };
+
+  static_assert(std::is_trivially_copyable_v<RenderJob>, "Render jobs must stay cheap to sort and copy.");
+
+  /** Per instance attributes of an instance batch. Layout matches the instance attributes in instancing.shader. */
+  struct InstanceTransform
+  {
+    Mat4 model;  //!< World transform.
+    Mat3 normal; //!< Inverse transpose of the world transform, computed once per instance instead of per vertex.
+  };
+
+  typedef std::vector<InstanceTransform> InstanceTransformArray;
+
+  /**
+   * Render jobs and their side tables. Jobs are sorted and partitioned in place while the side tables stay in the
+   * order that the jobs are created in. World transforms are contiguous, so uniform uploads and instance batches read
+   * them without copying the jobs.
+   * Provides the vector interface over the jobs to be used with the standard algorithms.
+   */
+  class TK_API RenderJobArray
+  {
+   public:
+    typedef std::vector<RenderJob>::iterator iterator;
+    typedef std::vector<RenderJob>::const_iterator const_iterator;
+
+    iterator begin() { return m_jobs.begin(); }
+
+    iterator end() { return m_jobs.end(); }
+
+    const_iterator begin() const { return m_jobs.begin(); }
+
+    const_iterator end() const { return m_jobs.end(); }
+
+    size_t size() const { return m_jobs.size(); }
+
+    bool empty() const { return m_jobs.empty(); }
+
+    RenderJob& operator[](size_t index) { return m_jobs[index]; }
+
+    const RenderJob& operator[](size_t index) const { return m_jobs[index]; }
+
+    RenderJob& front() { return m_jobs.front(); }
+
+    const RenderJob& front() const { return m_jobs.front(); }
+
+    /** Removes all jobs and their side table entries. Keeps the memory. */
+    void clear();
+
+    /** Reserves memory in the jobs and the side tables. */
+    void reserve(size_t count);
+
+    /** Resizes the jobs and the side tables. Added jobs index their own slots in the side tables. */
+    void resize(size_t count);
+
+    /** Appends a copy of the job and its side table entries from the source array. */
+    RenderJob& Add(const RenderJobArray& source, const RenderJob& job);
+
+    /** Appends all jobs of the other array. */
+    void Append(const RenderJobArray& other);
+
+    Mat4& GetTransform(const RenderJob& job) { return m_transforms[job.transformIndex]; }
+
+    const Mat4& GetTransform(const RenderJob& job) const { return m_transforms[job.transformIndex]; }
+
+    BoundingBox& GetBoundingBox(const RenderJob& job) { return m_boundingBoxes[job.transformIndex]; }
+
+    const BoundingBox& GetBoundingBox(const RenderJob& job) const { return m_boundingBoxes[job.transformIndex]; }
+
+    /** Returns the animation data of the job or null if the job is not animated. */
+    const AnimData* GetAnimData(const RenderJob& job) const { return m_animData[job.transformIndex]; }
+
+    /** Returns the instance transforms of the job's batch. Valid if the job's instance count is greater than 1. */
+    const InstanceTransform* GetInstanceTransforms(const RenderJob& job) const
+    {
+      return m_instanceTransforms.data() + job.instanceOffset;
+    }
+
+   public:
+    std::vector<RenderJob> m_jobs;               //!< Jobs in draw order once sorted.
+    Mat4Array m_transforms;                      //!< World transforms of the entities.
+    BoundingBoxArray m_boundingBoxes;            //!< World space bounding boxes.
+    std::vector<const AnimData*> m_animData;     //!< Animation data of the skeleton components. Valid for a frame.
+    InstanceTransformArray m_instanceTransforms; //!< Transforms of the instance batches, batch by batch.
+  };
+
+} // namespace ToolKit
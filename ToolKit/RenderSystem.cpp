@@ -8,7 +8,6 @@
 #include "RenderSystem.h"
 
 #include "GlErrorReporter.h"
-#include "LightCache.h"
 #include "Logger.h"
 #include "RHI.h"
 #include "TKOpenGL.h"
@@ -49,6 +49,7 @@ namespace ToolKit
     m_lightDataBuffer.Init();
 
     glGenQueries(1, &m_gpuTimerQuery);
+    glGenBuffers(1, &m_instanceBufferId);
 
     const char* renderer = (const char*) glGetString(GL_RENDERER);
     GetLogger()->Log(String("Graphics Card ") + renderer);
@@ -74,6 +75,11 @@ namespace ToolKit
     m_shadowAtlas                   = nullptr;
 
     m_lightDataBuffer.Destroy();
+
+    if (m_instanceBufferId != 0)
+    {
+      glDeleteBuffers(1, &m_instanceBufferId);
+    }
   }
 
   int Renderer::GetMaxArrayTextureLayers()
@@ -125,8 +131,14 @@ namespace ToolKit
     m_camFar                 = m_cam->Far();
   }
 
-  void Renderer::Render(const RenderJob& job)
+  void Renderer::Render(const RenderJobArray& jobs, const RenderJob& job)
   {
+    // Job is drawn by the first job of its instance batch.
+    if (job.instanceCount == 0)
+    {
+      return;
+    }
+
     // Make ibl assignments.
     m_renderState.IBLInUse = false;
     if (job.EnvironmentVolume)
@@ -165,13 +177,20 @@ namespace ToolKit
       {
         return;
       }
+      skel->Init();
 
-      if (job.animData.currentAnimation != nullptr)
+      const AnimData* animData = jobs.GetAnimData(job);
+      if (animData != nullptr && animData->currentAnimation != nullptr && animData->bonePalette != nullptr)
+      {
+        // Pose is evaluated on the cpu, the palette is sampled like the bind pose.
+        SetTexture(3, animData->bonePalette->m_textureId);
+      }
+      else if (animData != nullptr && animData->currentAnimation != nullptr)
       {
         // animation.
         AnimationPlayer* animPlayer = GetAnimationPlayer();
         DataTexturePtr animTexture =
-            animPlayer->GetAnimationDataTexture(skel->GetIdVal(), job.animData.currentAnimation->GetIdVal());
+            animPlayer->GetAnimationDataTexture(skel->GetIdVal(), animData->currentAnimation->GetIdVal());
 
         if (animTexture != nullptr)
         {
@@ -179,10 +198,13 @@ namespace ToolKit
         }
 
         // animation to blend.
-        if (job.animData.blendAnimation != nullptr)
+        if (animData->blendAnimation != nullptr)
         {
-          animTexture = animPlayer->GetAnimationDataTexture(skel->GetIdVal(), job.animData.blendAnimation->GetIdVal());
-          SetTexture(2, animTexture->m_textureId);
+          animTexture = animPlayer->GetAnimationDataTexture(skel->GetIdVal(), animData->blendAnimation->GetIdVal());
+          if (animTexture != nullptr)
+          {
+            SetTexture(2, animTexture->m_textureId);
+          }
         }
       }
       else
@@ -193,7 +215,7 @@ namespace ToolKit
 
     updateAndBindSkinningTextures();
 
-    m_model = job.WorldTransform;
+    m_model = jobs.GetTransform(job);
     job.Mesh->Init();
     job.Material->Init();
 
@@ -228,13 +250,36 @@ namespace ToolKit
     const Mesh* mesh = job.Mesh;
     activateSkinning(mesh);
 
-    FeedAnimationUniforms(m_currentProgram, job);
-    FeedLightUniforms(m_currentProgram, job);
+    bool isInstanced     = job.instanceCount > 1;
+    GLint isInstancedLoc = m_currentProgram->GetDefaultUniformLocation(Uniform::IS_INSTANCED);
+    glUniform1ui(isInstancedLoc, isInstanced ? 1 : 0);
+
+    FeedAnimationUniforms(m_currentProgram, jobs.GetAnimData(job));
+    FeedLightUniforms(m_currentProgram);
     FeedUniforms(m_currentProgram, job);
 
     RHI::BindVertexArray(mesh->m_vaoId);
 
-    if (mesh->m_indexCount != 0)
+    if (isInstanced)
+    {
+      BindInstanceTransforms(jobs.GetInstanceTransforms(job), job.instanceCount);
+
+      if (mesh->m_indexCount != 0)
+      {
+        glDrawElementsInstanced((GLenum) renderState->drawType,
+                                mesh->m_indexCount,
+                                GL_UNSIGNED_INT,
+                                nullptr,
+                                job.instanceCount);
+      }
+      else
+      {
+        glDrawArraysInstanced((GLenum) renderState->drawType, 0, mesh->m_vertexCount, job.instanceCount);
+      }
+
+      UnbindInstanceTransforms();
+    }
+    else if (mesh->m_indexCount != 0)
     {
       glDrawElements((GLenum) renderState->drawType, mesh->m_indexCount, GL_UNSIGNED_INT, nullptr);
     }
@@ -246,28 +291,74 @@ namespace ToolKit
     Stats::AddDrawCall();
   }
 
+  void Renderer::BindInstanceTransforms(const InstanceTransform* transforms, int count)
+  {
+    // Orphan and refill the buffer, each batch gets a fresh storage.
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceBufferId);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(InstanceTransform) * count, transforms, GL_STREAM_DRAW);
+
+    // Matrix attributes occupy consecutive locations, one column each.
+    GLsizei stride = sizeof(InstanceTransform);
+    for (GLuint i = 0; i < 4; i++)
+    {
+      GLuint location = InstanceTransformLocation + i;
+      glEnableVertexAttribArray(location);
+      glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, stride, (void*) (sizeof(Vec4) * i));
+      glVertexAttribDivisor(location, 1);
+    }
+
+    for (GLuint i = 0; i < 3; i++)
+    {
+      GLuint location = InstanceNormalLocation + i;
+      size_t offset   = offsetof(InstanceTransform, normal) + sizeof(Vec3) * i;
+      glEnableVertexAttribArray(location);
+      glVertexAttribPointer(location, 3, GL_FLOAT, GL_FALSE, stride, (void*) offset);
+      glVertexAttribDivisor(location, 1);
+    }
+  }
+
+  void Renderer::UnbindInstanceTransforms()
+  {
+    // Vertex array objects are shared with the non instanced draws, leave them as they were.
+    for (GLuint i = 0; i < 4; i++)
+    {
+      GLuint location = InstanceTransformLocation + i;
+      glVertexAttribDivisor(location, 0);
+      glDisableVertexAttribArray(location);
+    }
+
+    for (GLuint i = 0; i < 3; i++)
+    {
+      GLuint location = InstanceNormalLocation + i;
+      glVertexAttribDivisor(location, 0);
+      glDisableVertexAttribArray(location);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+  }
+
   void Renderer::RenderWithProgramFromMaterial(const RenderJobArray& jobs)
   {
     for (int i = 0; i < jobs.size(); ++i)
     {
-      RenderWithProgramFromMaterial(jobs[i]);
+      RenderWithProgramFromMaterial(jobs, jobs[i]);
     }
   }
 
-  void Renderer::RenderWithProgramFromMaterial(const RenderJob& job)
+  void Renderer::RenderWithProgramFromMaterial(const RenderJobArray& jobs, const RenderJob& job)
   {
     job.Material->Init();
     GpuProgramPtr program =
         m_gpuProgramManager->CreateProgram(job.Material->m_vertexShader, job.Material->m_fragmentShader);
     BindProgram(program);
-    Render(job);
+    Render(jobs, job);
   }
 
   void Renderer::Render(const RenderJobArray& jobs)
   {
     for (const RenderJob& job : jobs)
     {
-      Render(job);
+      Render(jobs, job);
     }
   }
 
@@ -477,6 +568,17 @@ namespace ToolKit
     glClear((GLbitfield) fields);
   }
 
+  void Renderer::ClearBufferRegion(GraphicBitFields fields, const Vec4& value, UVec2 offset, UVec2 size)
+  {
+    glEnable(GL_SCISSOR_TEST);
+    glScissor(offset.x, offset.y, size.x, size.y);
+
+    glClearColor(value.x, value.y, value.z, value.w);
+    glClear((GLbitfield) fields);
+
+    glDisable(GL_SCISSOR_TEST);
+  }
+
   void Renderer::ColorMask(bool r, bool g, bool b, bool a) { glColorMask(r, g, b, a); }
 
   void Renderer::CopyFrameBuffer(FramebufferPtr src, FramebufferPtr dest, GraphicBitFields fields)
@@ -862,6 +964,12 @@ namespace ToolKit
         glUniformMatrix4fv(uniformLoc, 1, false, &m_projectViewNoTranslate[0][0]);
       }
 
+      uniformLoc = program->GetDefaultUniformLocation(Uniform::PROJECT_VIEW);
+      if (uniformLoc != -1)
+      {
+        glUniformMatrix4fv(uniformLoc, 1, false, &m_projectView[0][0]);
+      }
+
       uniformLoc = program->GetDefaultUniformLocation(Uniform::CAM_DATA_POS);
       if (uniformLoc != -1)
       {
@@ -1170,62 +1278,63 @@ namespace ToolKit
     }
   }
 
-  void Renderer::FeedLightUniforms(const GpuProgramPtr& program, const RenderJob& job)
+  void Renderer::FeedLightUniforms(const GpuProgramPtr& program)
   {
-    GLint loc = program->GetDefaultUniformLocation(Uniform::LIGHT_DATA_ACTIVECOUNT);
-    if (loc != -1)
+    // Grid uniforms only change when a new grid is set.
+    if (program->m_lightGridVersion != m_lightGridVersion)
     {
-      glUniform1i(loc, (int) job.lights.size());
-    }
+      program->m_lightGridVersion = m_lightGridVersion;
 
-    if (job.lights.empty())
-    {
-      return;
-    }
-
-    m_lightCache.SetDrawCallVersion(m_drawCallVersion);
+      GLint loc                   = program->GetDefaultUniformLocation(Uniform::LIGHT_GRID_SIZE);
+      if (loc != -1)
+      {
+        if (m_lightGrid != nullptr)
+        {
+          glUniform4i(loc,
+                      LightGrid::TileCountX,
+                      LightGrid::TileCountY,
+                      LightGrid::SliceCount,
+                      m_lightGrid->m_directionalLightCount);
+        }
+        else
+        {
+          // Empty grid, no lights.
+          glUniform4i(loc, 0, 0, 0, 0);
+        }
+      }
 
-    if (GetRenderSystem()->ConsumeGPULightCacheInvalidation())
-    {
-      m_lightCache.UpdateVersion(); // This will cause an update of the cache.
-    }
+      if (m_lightGrid == nullptr)
+      {
+        return;
+      }
 
-    // Make sure the cache has the lights that is going to rendered
-    for (uint i = 0; i < job.lights.size(); ++i)
-    {
-      Light* light             = job.lights[i];
-      light->m_drawCallVersion = m_drawCallVersion;
+      loc = program->GetDefaultUniformLocation(Uniform::LIGHT_GRID_SLICING);
+      if (loc != -1)
+      {
+        glUniform3fv(loc, 1, &m_lightGrid->m_slicing.x);
+      }
 
-      int indexInCache         = m_lightCache.Contains(light);
-      if (indexInCache != -1)
+      loc = program->GetDefaultUniformLocation(Uniform::LIGHT_GRID_TILE_SIZE);
+      if (loc != -1)
       {
-        // If light is invalidated or cache index has changed, invalidate the light cache.
-        if (light->m_invalidatedForLightCache || light->m_lightCacheIndex != indexInCache)
-        {
-          light->m_lightCacheIndex          = indexInCache;
-          light->m_invalidatedForLightCache = false;
-          m_lightCache.UpdateVersion(); // Light needs to be updated, invalidate the cache.
-        }
+        glUniform2fv(loc, 1, &m_lightGridTileSize.x);
       }
-      else
+
+      loc = program->GetDefaultUniformLocation(Uniform::CASCADE_DISTANCES);
+      if (loc != -1)
       {
-        light->m_lightCacheIndex = m_lightCache.Add(light); // Add will cause a cache invalidation.
+        glUniform4fv(loc, 1, GetEngineSettings().Graphics.cascadeDistances);
       }
     }
 
-    m_drawCallVersion++;
-
-    // When cache is invalidated, update the cache for this program
-    if (program->m_lightCacheVersion != m_lightCache.GetVersion())
+    if (m_lightGrid == nullptr)
     {
-      // Update the cache.
-      program->m_lightCacheVersion = m_lightCache.GetVersion();
-      m_lightDataBuffer.UpdateLightCache(m_lightCache.GetLights(), RHIConstants::LightCacheSize);
-      m_lightDataBuffer.UpdateActiveLights(job.lights, true);
+      return;
     }
 
-    // Checks the current active light indexes, perform the update only if necessary.
-    m_lightDataBuffer.UpdateActiveLights(job.lights);
+    SetTexture(10, m_lightDataBuffer.m_clusterTextureId);
+    SetTexture(11, m_lightDataBuffer.m_lightIndexTextureId);
+    SetTexture(13, m_lightDataBuffer.m_lightDataTextureId);
 
     // Bind shadow map if activated
     if (m_shadowAtlas != nullptr)
@@ -1234,18 +1343,24 @@ namespace ToolKit
     }
   }
 
-  void Renderer::FeedAnimationUniforms(const GpuProgramPtr& program, const RenderJob& job)
+  void Renderer::FeedAnimationUniforms(const GpuProgramPtr& program, const AnimData* animData)
   {
-    // Send if its animated or not.
-    int uniformLoc = program->GetDefaultUniformLocation(Uniform::IS_ANIMATED);
+    // Send if its animated or not. A bone palette is already posed, it is sampled like the bind pose.
+    bool isAnimated = animData != nullptr && animData->currentAnimation != nullptr && animData->bonePalette == nullptr;
+    int uniformLoc  = program->GetDefaultUniformLocation(Uniform::IS_ANIMATED);
     if (uniformLoc != -1)
     {
-      glUniform1ui(uniformLoc, job.animData.currentAnimation != nullptr);
+      glUniform1ui(uniformLoc, isAnimated);
     }
 
-    if (job.animData.currentAnimation == nullptr)
+    if (!isAnimated)
     {
-      // If not animated, just skip the rest.
+      // If not animated, just skip the rest. Blending is baked into the palette.
+      uniformLoc = program->GetDefaultUniformLocation(Uniform::BLEND_ANIMATION);
+      if (uniformLoc != -1)
+      {
+        glUniform1i(uniformLoc, 0);
+      }
       return;
     }
 
@@ -1253,27 +1368,27 @@ namespace ToolKit
     uniformLoc = program->GetDefaultUniformLocation(Uniform::KEY_FRAME_COUNT);
     if (uniformLoc != -1)
     {
-      glUniform1f(uniformLoc, job.animData.keyFrameCount);
+      glUniform1f(uniformLoc, animData->keyFrameCount);
     }
 
-    if (job.animData.keyFrameCount > 0)
+    if (animData->keyFrameCount > 0)
     {
       uniformLoc = program->GetDefaultUniformLocation(Uniform::KEY_FRAME_1);
       if (uniformLoc != -1)
       {
-        glUniform1f(uniformLoc, job.animData.firstKeyFrame);
+        glUniform1f(uniformLoc, animData->firstKeyFrame);
       }
 
       uniformLoc = program->GetDefaultUniformLocation(Uniform::KEY_FRAME_2);
       if (uniformLoc != -1)
       {
-        glUniform1f(uniformLoc, job.animData.secondKeyFrame);
+        glUniform1f(uniformLoc, animData->secondKeyFrame);
       }
 
       uniformLoc = program->GetDefaultUniformLocation(Uniform::KEY_FRAME_INT_TIME);
       if (uniformLoc != -1)
       {
-        glUniform1f(uniformLoc, job.animData.keyFrameInterpolationTime);
+        glUniform1f(uniformLoc, animData->keyFrameInterpolationTime);
       }
     }
 
@@ -1281,39 +1396,39 @@ namespace ToolKit
     uniformLoc = program->GetDefaultUniformLocation(Uniform::BLEND_ANIMATION);
     if (uniformLoc != -1)
     {
-      glUniform1i(uniformLoc, job.animData.blendAnimation != nullptr);
+      glUniform1i(uniformLoc, animData->blendAnimation != nullptr);
     }
 
-    if (job.animData.blendAnimation != nullptr)
+    if (animData->blendAnimation != nullptr)
     {
       uniformLoc = program->GetDefaultUniformLocation(Uniform::BLEND_FACTOR);
       if (uniformLoc != -1)
       {
-        glUniform1f(uniformLoc, job.animData.animationBlendFactor);
+        glUniform1f(uniformLoc, animData->animationBlendFactor);
       }
 
       uniformLoc = program->GetDefaultUniformLocation(Uniform::BLEND_KEY_FRAME_1);
       if (uniformLoc != -1)
       {
-        glUniform1f(uniformLoc, job.animData.blendFirstKeyFrame);
+        glUniform1f(uniformLoc, animData->blendFirstKeyFrame);
       }
 
       uniformLoc = program->GetDefaultUniformLocation(Uniform::BLEND_KEY_FRAME_2);
       if (uniformLoc != -1)
       {
-        glUniform1f(uniformLoc, job.animData.blendSecondKeyFrame);
+        glUniform1f(uniformLoc, animData->blendSecondKeyFrame);
       }
 
       uniformLoc = program->GetDefaultUniformLocation(Uniform::BLEND_KEY_FRAME_INT_TIME);
       if (uniformLoc != -1)
       {
-        glUniform1f(uniformLoc, job.animData.blendKeyFrameInterpolationTime);
+        glUniform1f(uniformLoc, animData->blendKeyFrameInterpolationTime);
       }
 
       uniformLoc = program->GetDefaultUniformLocation(Uniform::BLEND_KEY_FRAME_COUNT);
       if (uniformLoc != -1)
       {
-        glUniform1f(uniformLoc, job.animData.blendKeyFrameCount);
+        glUniform1f(uniformLoc, animData->blendKeyFrameCount);
       }
     }
   }
@@ -1333,10 +1448,10 @@ namespace ToolKit
         GL_TEXTURE_CUBE_MAP, // 7 -> Irradiance Map
         GL_TEXTURE_2D_ARRAY, // 8 -> Shadow Atlas
         GL_TEXTURE_2D,       // 9 -> Normal map, gbuffer position
-        GL_TEXTURE_2D,       // 10 -> gBuffer normal texture
-        GL_TEXTURE_2D,       // 11 -> gBuffer color texture
+        GL_TEXTURE_2D,       // 10 -> Light grid clusters
+        GL_TEXTURE_2D,       // 11 -> Light grid light indices
         GL_TEXTURE_2D,       // 12 -> gBuffer emissive texture
-        GL_TEXTURE_2D,       // 13 -> EMPTY
+        GL_TEXTURE_2D,       // 13 -> Light data
         GL_TEXTURE_2D,       // 14 -> gBuffer metallic roughness texture
         GL_TEXTURE_CUBE_MAP, // 15 -> IBL Specular Pre-Filtered Map
         GL_TEXTURE_2D        // 16 -> IBL BRDF Lut
@@ -1347,6 +1462,20 @@ namespace ToolKit
 
   void Renderer::SetShadowAtlas(TexturePtr shadowAtlas) { m_shadowAtlas = shadowAtlas; }
 
+  void Renderer::SetLightGrid(const LightGrid* lightGrid)
+  {
+    m_lightGrid = lightGrid;
+    m_lightGridVersion++;
+
+    if (m_lightGrid != nullptr)
+    {
+      m_lightGridTileSize.x = (float) m_viewportSize.x / (float) LightGrid::TileCountX;
+      m_lightGridTileSize.y = (float) m_viewportSize.y / (float) LightGrid::TileCountY;
+
+      m_lightDataBuffer.Update(*m_lightGrid);
+    }
+  }
+
   CubeMapPtr Renderer::GenerateCubemapFrom2DTexture(TexturePtr texture, uint size, float exposure)
   {
     const TextureSettings set = {GraphicTypes::TargetCubeMap,
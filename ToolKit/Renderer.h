@@ -9,10 +9,10 @@
 
 #include "Camera.h"
 #include "GpuProgram.h"
-#include "LightCache.h"
 #include "LightDataBuffer.h"
 #include "Primative.h"
 #include "RHIConstants.h"
+#include "RenderJob.h"
 #include "RenderState.h"
 #include "Sky.h"
 #include "Types.h"
@@ -24,6 +24,11 @@ namespace ToolKit
   class TK_API Renderer
   {
    public:
+    /** First attribute location of the per instance world transform. Matches instancing.shader. */
+    static constexpr uint InstanceTransformLocation = 6;
+    /** First attribute location of the per instance normal matrix. Matches instancing.shader. */
+    static constexpr uint InstanceNormalLocation    = 10;
+
     Renderer();
     ~Renderer();
 
@@ -40,6 +45,10 @@ namespace ToolKit
 
     void ClearColorBuffer(const Vec4& color);
     void ClearBuffer(GraphicBitFields fields, const Vec4& value = Vec4(0.0f));
+
+    /** Clears the buffers only within the rectangle, the rest of the framebuffer is preserved. */
+    void ClearBufferRegion(GraphicBitFields fields, const Vec4& value, UVec2 offset, UVec2 size);
+
     void ColorMask(bool r, bool g, bool b, bool a);
 
     // FrameBuffer Operations
@@ -99,11 +108,19 @@ namespace ToolKit
     // Giving nullptr as argument means no shadows
     void SetShadowAtlas(TexturePtr shadowAtlas);
 
-    void Render(const struct RenderJob& job);
+    /**
+     * Sets the light grid that the lit materials fetch their lights from and uploads it to the gpu. Must be set after
+     * the framebuffer that the grid is used for, tiles are sized by the viewport.
+     * Giving nullptr as argument means no lights.
+     */
+    void SetLightGrid(const LightGrid* lightGrid);
+
+    /** Renders the job with its transform and animation data from the job array. */
+    void Render(const RenderJobArray& jobs, const RenderJob& job);
     void Render(const RenderJobArray& jobs);
 
     void RenderWithProgramFromMaterial(const RenderJobArray& jobs);
-    void RenderWithProgramFromMaterial(const RenderJob& job);
+    void RenderWithProgramFromMaterial(const RenderJobArray& jobs, const RenderJob& job);
 
     /** Apply one tap of gauss blur via setting a temporary frame buffer. Does not reset frame buffer back. */
     void Apply7x1GaussianBlur(const TexturePtr src, RenderTargetPtr dst, const Vec3& axis, const float amount);
@@ -130,9 +147,14 @@ namespace ToolKit
     void SetAmbientOcclusionTexture(TexturePtr aoTexture);
 
    private:
+    /** Uploads the transforms to the instance buffer and binds them as per instance attributes to the bound vao. */
+    void BindInstanceTransforms(const InstanceTransform* transforms, int count);
+    /** Restores the instance attributes of the bound vao. */
+    void UnbindInstanceTransforms();
+
     void FeedUniforms(const GpuProgramPtr& program, const RenderJob& job);
-    void FeedLightUniforms(const GpuProgramPtr& program, const RenderJob& job);
-    void FeedAnimationUniforms(const GpuProgramPtr& program, const RenderJob& job);
+    void FeedLightUniforms(const GpuProgramPtr& program);
+    void FeedAnimationUniforms(const GpuProgramPtr& program, const AnimData* animData);
 
    public:
     uint m_frameCount = 0;
@@ -149,11 +171,12 @@ namespace ToolKit
     std::unordered_set<uint> m_gpuProgramHasFrameUpdates;
 
     bool m_renderOnlyLighting = false;
-    LightCache<RHIConstants::LightCacheSize> m_lightCache;
 
    private:
     LightDataBuffer m_lightDataBuffer;
-    uint16 m_drawCallVersion       = 1;
+    const LightGrid* m_lightGrid = nullptr;
+    Vec2 m_lightGridTileSize;           //!< Size of a light grid tile in pixels.
+    uint64 m_lightGridVersion      = 1; //!< Incremented each time a light grid is set. Never wraps.
 
     GpuProgramPtr m_currentProgram = nullptr;
 
@@ -202,6 +225,7 @@ namespace ToolKit
     GpuProgramManager* m_gpuProgramManager         = nullptr;
 
     uint m_gpuTimerQuery                           = 0;
+    uint m_instanceBufferId                        = 0; //!< Per instance world transforms of instanced draws.
     float m_cpuTime                                = 0.0f;
     bool m_blendStateOverrideEnable                = false;
   };
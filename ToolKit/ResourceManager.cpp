@@ -41,6 +41,8 @@ namespace ToolKit
 
   void ResourceManager::Manage(ResourcePtr resource)
   {
+    std::lock_guard<std::recursive_mutex> storageLock(m_storageMutex);
+
     String file  = resource->GetFile();
     bool sane    = !file.empty();
     sane        &= !Exist(file);
@@ -54,10 +56,73 @@ namespace ToolKit
 
   String ResourceManager::GetDefaultResource(ClassMeta* Class) { return String(); }
 
-  bool ResourceManager::Exist(const String& file) { return m_storage.find(file) != m_storage.end(); }
+  ResourcePtr ResourceManager::FindOrWaitLoad(const String& file)
+  {
+    std::shared_future<void> loaded;
+    ResourcePtr resource = nullptr;
+    {
+      std::lock_guard<std::recursive_mutex> storageLock(m_storageMutex);
+
+      auto storageItr = m_storage.find(file);
+      if (storageItr == m_storage.end())
+      {
+        return nullptr;
+      }
+      resource     = storageItr->second;
+
+      auto pending = m_pendingLoads.find(file);
+      if (pending != m_pendingLoads.end() && pending->second.loadingThread != std::this_thread::get_id())
+      {
+        loaded = pending->second.loaded;
+      }
+    }
+
+    if (loaded.valid())
+    {
+      loaded.wait();
+    }
+
+    return resource;
+  }
+
+  ResourcePtr ResourceManager::InsertForLoad(const String& file,
+                                             const ResourcePtr& resource,
+                                             std::promise<void>& loaded)
+  {
+    {
+      std::lock_guard<std::recursive_mutex> storageLock(m_storageMutex);
+
+      if (m_storage.find(file) == m_storage.end())
+      {
+        m_storage[file]      = resource;
+        m_pendingLoads[file] = {loaded.get_future().share(), std::this_thread::get_id()};
+        return nullptr;
+      }
+    }
+
+    return FindOrWaitLoad(file);
+  }
+
+  void ResourceManager::CompleteLoad(const String& file, std::promise<void>& loaded)
+  {
+    {
+      std::lock_guard<std::recursive_mutex> storageLock(m_storageMutex);
+      m_pendingLoads.erase(file);
+    }
+
+    loaded.set_value();
+  }
+
+  bool ResourceManager::Exist(const String& file)
+  {
+    std::lock_guard<std::recursive_mutex> storageLock(m_storageMutex);
+    return m_storage.find(file) != m_storage.end();
+  }
 
   ResourcePtr ResourceManager::Remove(const String& file)
   {
+    std::lock_guard<std::recursive_mutex> storageLock(m_storageMutex);
+
     ResourcePtr resource = nullptr;
     auto mapItr          = m_storage.find(file);
     if (mapItr != m_storage.end())
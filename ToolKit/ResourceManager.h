@@ -33,36 +33,51 @@ namespace ToolKit
     ResourceManager(const ResourceManager&) = delete;
     void operator=(const ResourceManager&)  = delete;
 
+    /**
+     * Returns the resource for the file, creates and loads it if it doesn't exist. Can be called from multiple threads.
+     * The storage is only locked to look up and insert the resource. The resource is loaded outside of the lock, by
+     * the thread that inserts it. Other threads requesting the same file wait for the load to complete.
+     */
     template <typename T>
     std::shared_ptr<T> Create(const String& file)
     {
-      if (!Exist(file))
+      if (ResourcePtr resource = FindOrWaitLoad(file))
       {
-        ResourcePtr resource = MakeNewPtr<T>();
-        if (!CheckFile(file))
-        {
-          String def = GetDefaultResource(T::StaticClass());
-          if (!CheckFile(def))
-          {
-            TK_ERR("No default for Class %s", T::StaticClass()->Name.c_str());
-            assert(0 && "No default resource!");
-            return nullptr;
-          }
-
-          String rel = GetRelativeResourcePath(file);
-          TK_WRN("File: %s is missing. Using default resource.", rel.c_str());
-          resource->SetFile(def);
-          resource->_missingFile = file;
-        }
-        else
+        return tk_reinterpret_pointer_cast<T>(resource);
+      }
+
+      ResourcePtr resource = MakeNewPtr<T>();
+      if (!CheckFile(file))
+      {
+        String def = GetDefaultResource(T::StaticClass());
+        if (!CheckFile(def))
         {
-          resource->SetFile(file);
+          TK_ERR("No default for Class %s", T::StaticClass()->Name.c_str());
+          assert(0 && "No default resource!");
+          return nullptr;
         }
 
-        resource->Load();
-        m_storage[file] = resource;
+        String rel = GetRelativeResourcePath(file);
+        TK_WRN("File: %s is missing. Using default resource.", rel.c_str());
+        resource->SetFile(def);
+        resource->_missingFile = file;
+      }
+      else
+      {
+        resource->SetFile(file);
+      }
+
+      // Another thread may have inserted the file meanwhile, the first one loads it.
+      std::promise<void> loaded;
+      if (ResourcePtr existing = InsertForLoad(file, resource, loaded))
+      {
+        return tk_reinterpret_pointer_cast<T>(existing);
       }
-      return tk_reinterpret_pointer_cast<T>(m_storage[file]);
+
+      resource->Load();
+      CompleteLoad(file, loaded);
+
+      return tk_reinterpret_pointer_cast<T>(resource);
     }
 
     template <typename T>
@@ -81,9 +96,41 @@ namespace ToolKit
     bool Exist(const String& file);
     ResourcePtr Remove(const String& file);
 
+   private:
+    /** Returns the stored resource for the file or null. Waits if the resource is being loaded by another thread. */
+    ResourcePtr FindOrWaitLoad(const String& file);
+
+    /**
+     * Inserts the resource to the storage and marks it as loading, unless the file is already stored.
+     * @returns The stored resource if the file exists, after waiting for its load. Null if the resource is inserted.
+     */
+    ResourcePtr InsertForLoad(const String& file, const ResourcePtr& resource, std::promise<void>& loaded);
+
+    /** Signals the threads waiting for the resource of the file. */
+    void CompleteLoad(const String& file, std::promise<void>& loaded);
+
+    /**
+     * Load in progress. Other threads wait for it. The loading thread doesn't, as when a resource loads itself again.
+     */
+    struct PendingLoad
+    {
+      std::shared_future<void> loaded;
+      std::thread::id loadingThread;
+    };
+
    public:
     std::unordered_map<String, ResourcePtr> m_storage;
     ClassMeta* m_baseType = nullptr;
+
+    /**
+     * Guards the storage. Allows resources to be created from multiple threads, such as parallel scene loading.
+     * Recursive, because the managers call the locking functions from each other.
+     */
+    std::recursive_mutex m_storageMutex;
+
+   private:
+    /** Resources in the storage that are being loaded. Guarded by the storage mutex. */
+    std::unordered_map<String, PendingLoad> m_pendingLoads;
   };
 
 } // namespace ToolKit
@@ -16,6 +16,7 @@
 #include "MathUtil.h"
 #include "Mesh.h"
 #include "Prefab.h"
+#include "Threads.h"
 #include "ToolKit.h"
 #include "Util.h"
 
@@ -174,6 +175,8 @@ namespace ToolKit
       AddEntity(otherNtt);
     }
 
+    m_aabbTree.Rebuild();
+
     other->RemoveAllEntities();
     GetSceneManager()->Remove(other->GetFile());
   }
@@ -276,18 +279,15 @@ namespace ToolKit
 
   EntityPtr Scene::GetEntity(ULongID id, int* index) const
   {
-    for (int i = 0; i < (int) m_entities.size(); i++)
+    auto nttIndx = m_entityIndices.find(id);
+    if (nttIndx != m_entityIndices.end())
     {
-      EntityPtr ntt = m_entities[i];
-      if (ntt->GetIdVal() == id)
+      if (index != nullptr)
       {
-        if (index != nullptr)
-        {
-          *index = i;
-        }
-
-        return ntt;
+        *index = nttIndx->second;
       }
+
+      return m_entities[nttIndx->second];
     }
 
     if (index != nullptr)
@@ -321,11 +321,13 @@ namespace ToolKit
 
         if (index < 0 || index >= (int) m_entities.size())
         {
+          m_entityIndices[entity->GetIdVal()] = (int) m_entities.size();
           m_entities.push_back(entity);
         }
         else
         {
           m_entities.insert(m_entities.begin() + index, entity);
+          UpdateEntityIndices(index);
         }
 
         entity->m_scene = Self<Scene>();
@@ -373,7 +375,24 @@ namespace ToolKit
     }
 
     UpdateEntityCaches(removed, false);
-    m_entities.erase(m_entities.begin() + indx);
+
+    if (m_keepEntityOrder)
+    {
+      m_entities.erase(m_entities.begin() + indx);
+      m_entityIndices.erase(id);
+      UpdateEntityIndices(indx);
+    }
+    else
+    {
+      // Move the last entity to the removed slot, only its index changes.
+      if (indx != (int) m_entities.size() - 1)
+      {
+        m_entities[indx]                              = std::move(m_entities.back());
+        m_entityIndices[m_entities[indx]->GetIdVal()] = indx;
+      }
+      m_entities.pop_back();
+      m_entityIndices.erase(id);
+    }
 
     if (deep)
     {
@@ -401,7 +420,11 @@ namespace ToolKit
     }
   }
 
-  void Scene::RemoveAllEntities() { m_entities.clear(); }
+  void Scene::RemoveAllEntities()
+  {
+    m_entities.clear();
+    m_entityIndices.clear();
+  }
 
   const EntityPtrArray& Scene::GetEntities() const { return m_entities; }
 
@@ -512,6 +535,7 @@ namespace ToolKit
     }
 
     m_entities.clear();
+    m_entityIndices.clear();
     m_aabbTree.Reset();
 
     m_lightCache.clear();
@@ -534,6 +558,7 @@ namespace ToolKit
     ScenePtr prefab            = MakeNewPtr<Scene>();
     prefab->AddEntity(entity);
     GetChildren(entity, prefab->m_entities);
+    prefab->UpdateEntityIndices();
     String prefabName = name.empty() ? entity->GetNameVal() + SCENE : name + SCENE;
     String prefabPath = path.empty() ? prefabName : ConcatPaths({path, prefabName});
     String fullPath   = PrefabPath(prefabPath);
@@ -541,6 +566,7 @@ namespace ToolKit
     prefab->m_name = name;
     prefab->Save(false);
     prefab->m_entities.clear();
+    prefab->m_entityIndices.clear();
 
     // Restore the old node.
     entity->m_node->m_children.clear();
@@ -552,6 +578,7 @@ namespace ToolKit
   {
     m_aabbTree.Reset();
     m_entities.clear();
+    m_entityIndices.clear();
   }
 
   const BoundingBox& Scene::GetSceneBoundary() { return m_aabbTree.GetRootBoundingBox(); }
@@ -570,6 +597,8 @@ namespace ToolKit
     {
       DeepCopy(ntt, cpy->m_entities);
     }
+
+    cpy->UpdateEntityIndices();
   }
 
   void Scene::UpdateEntityCaches(const EntityPtr& ntt, bool add)
@@ -623,6 +652,20 @@ namespace ToolKit
     }
   }
 
+  void Scene::UpdateEntityIndices(int startIndex)
+  {
+    if (startIndex == 0)
+    {
+      m_entityIndices.clear();
+      m_entityIndices.reserve(m_entities.size());
+    }
+
+    for (int i = startIndex; i < (int) m_entities.size(); i++)
+    {
+      m_entityIndices[m_entities[i]->GetIdVal()] = i;
+    }
+  }
+
   XmlNode* Scene::SerializeImp(XmlDocument* doc, XmlNode* parent) const
   {
     XmlNode* scene = CreateXmlNode(doc, XmlSceneElement, parent);
@@ -699,15 +742,19 @@ namespace ToolKit
     }
 
     // Solve the parent-child relations
-    for (EntityPtr ntt : deserializedEntities)
+    std::unordered_map<ULongID, Entity*> idToEntity;
+    idToEntity.reserve(deserializedEntities.size());
+    for (EntityPtr& ntt : deserializedEntities)
     {
-      for (EntityPtr parentCandidate : deserializedEntities)
+      idToEntity.insert({ntt->GetIdVal(), ntt.get()});
+    }
+
+    for (EntityPtr& ntt : deserializedEntities)
+    {
+      auto parent = idToEntity.find(ntt->_parentId);
+      if (parent != idToEntity.end())
       {
-        if (parentCandidate->GetIdVal() == ntt->_parentId)
-        {
-          parentCandidate->m_node->AddChild(ntt->m_node);
-          break;
-        }
+        parent->second->m_node->AddChild(ntt->m_node);
       }
     }
 
@@ -734,6 +781,9 @@ namespace ToolKit
       prefab->Link();
     }
 
+    // Incrementally constructed tree is far from optimal, rebuild it once all entities are in.
+    m_aabbTree.Rebuild();
+
     return nullptr;
   }
 
@@ -748,45 +798,69 @@ namespace ToolKit
     const char* xmlRootObject = Object::StaticClass()->Name.c_str();
     const char* xmlObjectType = XmlObjectClassAttr.data();
 
+    std::vector<XmlNode*> entityNodes;
     for (node = root->first_node(xmlRootObject); node; node = node->next_sibling(xmlRootObject))
     {
-      XmlAttribute* typeAttr = node->first_attribute(xmlObjectType);
-      EntityPtr ntt          = MakeNewPtrCasted<Entity>(typeAttr->value());
+      entityNodes.push_back(node);
+    }
 
-      ntt->DeSerialize(info, node);
+    // Entities are independent from each other, create and deserialize them in parallel.
+    deserializedEntities.resize(entityNodes.size());
+
+    using poolstl::iota_iter;
+    std::for_each(TKExecByConditional(entityNodes.size() > 100, WorkerManager::FramePool),
+                  iota_iter<size_t>(0),
+                  iota_iter<size_t>(entityNodes.size()),
+                  [&](size_t nodeIndex)
+                  {
+                    // Resource loading may issue parallel loops, run them on this thread.
+                    ParallelTaskScope taskScope;
+
+                    XmlNode* nttNode       = entityNodes[nodeIndex];
+                    XmlAttribute* typeAttr = nttNode->first_attribute(xmlObjectType);
+                    EntityPtr ntt          = MakeNewPtrCasted<Entity>(typeAttr->value());
+
+                    ntt->DeSerialize(info, nttNode);
+                    deserializedEntities[nodeIndex] = ntt;
+                  });
 
+    // Prefabs load their own scenes, initialize them serially.
+    for (EntityPtr& ntt : deserializedEntities)
+    {
       if (Prefab* prefab = ntt->As<Prefab>())
       {
         prefab->Init(Self<Scene>());
         prefabList.push_back(ntt);
       }
-
-      deserializedEntities.push_back(ntt);
     }
 
     // Solve the parent-child relations
     m_entities.reserve(deserializedEntities.size());
+    m_entityIndices.reserve(deserializedEntities.size());
 
-    for (EntityPtr ntt : deserializedEntities)
+    // Map entities by the ids in the file. Colliding ids are regenerated, so use the id before collision for them.
+    std::unordered_map<ULongID, Entity*> fileIdToEntity;
+    fileIdToEntity.reserve(deserializedEntities.size());
+
+    for (EntityPtr& ntt : deserializedEntities)
     {
-      if (ntt->_parentId == NULL_HANDLE)
+      ULongID id = ntt->_idBeforeCollision;
+      if (id == NULL_HANDLE)
       {
-        AddEntity(ntt);
-        continue;
+        id = ntt->GetIdVal();
       }
 
-      for (EntityPtr parentCandidate : deserializedEntities)
-      {
-        ULongID id = parentCandidate->_idBeforeCollision;
-        if (id == NULL_HANDLE)
-        {
-          id = parentCandidate->GetIdVal();
-        }
+      fileIdToEntity.insert({id, ntt.get()});
+    }
 
-        if (ntt->_parentId == id)
+    for (EntityPtr& ntt : deserializedEntities)
+    {
+      if (ntt->_parentId != NULL_HANDLE)
+      {
+        auto parent = fileIdToEntity.find(ntt->_parentId);
+        if (parent != fileIdToEntity.end())
         {
-          parentCandidate->m_node->AddChild(ntt->m_node);
-          break;
+          parent->second->m_node->AddChild(ntt->m_node);
         }
       }
 
@@ -800,6 +874,9 @@ namespace ToolKit
       PrefabPtr prefab = Cast<Prefab>(ntt);
       prefab->Link();
     }
+
+    // Incrementally constructed tree is far from optimal, rebuild it once all entities are in.
+    m_aabbTree.Rebuild();
   }
 
   ULongID Scene::GetBiggestEntityId()
@@ -199,7 +199,8 @@ namespace ToolKit
     void LinkPrefab(const String& fullPath);
 
     /**
-     * Removes the entity with the given id from the scene.
+     * Removes the entity with the given id from the scene in constant time. The last entity takes the place of the
+     * removed one, unless the scene keeps the entity order.
      * @param  The id of the entity that will be removed.
      * @param  States if the remove will be recursive to the all leafs.
      * @returns The removed entity.
@@ -274,6 +275,13 @@ namespace ToolKit
      */
     void UpdateEntityCaches(const EntityPtr& ntt, bool add);
 
+    /**
+     * Updates the id to index lookup for the entities starting from the given index to the end of the entity array.
+     * Must be called after any operation that shifts entities in the array.
+     * @param startIndex The first index in the entity array whose lookup will be updated.
+     */
+    void UpdateEntityIndices(int startIndex = 0);
+
    private:
     /**
      * Internally used only.
@@ -294,6 +302,15 @@ namespace ToolKit
     EntityPtrArray m_entities; //!< The entities in the scene.
     bool m_isPrefab;           //!< Whether or not the scene is a prefab.
 
+    /** Entity id to index in the entity array lookup. Provides constant time entity queries by id. */
+    std::unordered_map<ULongID, int> m_entityIndices;
+
+    /**
+     * Removal shifts the following entities instead of swapping the last entity in, which is linear in the entity
+     * count. Needed by the scenes that display or reorder the entities by their order.
+     */
+    bool m_keepEntityOrder = false;
+
     mutable LightRawPtrArray m_lightCache;                         //!< Cached light entities which is added to scene.
     mutable LightRawPtrArray m_directionalLightCache;              //!< Cached directional lights in the scene.
     mutable EnvironmentComponentPtrArray m_environmentVolumeCache; //!< Environment volumes in the scene.
@@ -160,6 +160,18 @@ namespace ToolKit
       return "aoEnabled";
     case Uniform::ACTIVE_LIGHT_INDICES:
       return "activeLightIndices";
+    case Uniform::IS_INSTANCED:
+      return "isInstanced";
+    case Uniform::PROJECT_VIEW:
+      return "ProjectView";
+    case Uniform::LIGHT_GRID_SIZE:
+      return "lightGridSize";
+    case Uniform::LIGHT_GRID_SLICING:
+      return "lightGridSlicing";
+    case Uniform::LIGHT_GRID_TILE_SIZE:
+      return "lightGridTileSize";
+    case Uniform::CASCADE_DISTANCES:
+      return "cascadeDistances";
     case Uniform::UNIFORM_MAX_INVALID:
     default:
       return "";
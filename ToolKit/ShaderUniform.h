@@ -91,6 +91,12 @@ namespace ToolKit
     MODEL_NO_TR,
     AO_ENABLED,
     ACTIVE_LIGHT_INDICES,
+    IS_INSTANCED,
+    PROJECT_VIEW,
+    LIGHT_GRID_SIZE,
+    LIGHT_GRID_SLICING,
+    LIGHT_GRID_TILE_SIZE,
+    CASCADE_DISTANCES,
     UNIFORM_MAX_INVALID
   };
 
@@ -14,6 +14,7 @@
 #include "Material.h"
 #include "MathUtil.h"
 #include "Mesh.h"
+#include "MeshComponent.h"
 #include "RHI.h"
 #include "RHIConstants.h"
 #include "RenderSystem.h"
@@ -75,15 +76,7 @@ namespace ToolKit
     Renderer* renderer        = GetRenderer();
     const Vec4 lastClearColor = renderer->m_clearColor;
 
-    // Clear shadow atlas before any draw call
-    renderer->SetFramebuffer(m_shadowFramebuffer, GraphicBitFields::AllBits);
-    for (int i = 0; i < m_layerCount; i++)
-    {
-      m_shadowFramebuffer->SetColorAttachment(Framebuffer::Attachment::ColorAttachment0, m_shadowAtlas, 0, i);
-      renderer->ClearBuffer(GraphicBitFields::ColorBits, m_shadowClearColor);
-    }
-
-    // Update shadow maps.
+    // Update shadow cameras.
     for (Light* light : m_lights)
     {
       light->UpdateShadowCamera();
@@ -93,12 +86,33 @@ namespace ToolKit
         DirectionalLight* dLight = static_cast<DirectionalLight*>(light);
         dLight->UpdateShadowFrustum(m_params.viewCamera, m_params.scene);
       }
+    }
+
+    CullShadowCasters();
+
+    // Shadow maps stay in the atlas across frames. Only the ones whose camera or casters changed are rendered.
+    m_updatedShadowMapCount = 0;
+    m_skippedShadowMapCount = 0;
+    ScheduleShadowMapUpdates();
+
+    renderer->SetFramebuffer(m_shadowFramebuffer, GraphicBitFields::None);
 
-      RenderShadowMaps(light);
+    int shadowMapIndex = 0;
+    for (Light* light : m_lights)
+    {
+      RenderShadowMaps(light, shadowMapIndex);
     }
 
+    if (TKStats* stats = GetTKStats())
+    {
+      stats->m_shadowMapUpdatesPerFrame += m_updatedShadowMapCount;
+      stats->m_shadowMapSkipsPerFrame   += m_skippedShadowMapCount;
+    }
+
+    m_frameCount++;
+
     // The first set attachment did not call hw render pass while rendering shadow map
-    if (m_lights.size() > 0)
+    if (m_updatedShadowMapCount > 0)
     {
       Stats::RemoveHWRenderPass();
     }
@@ -151,128 +165,318 @@ namespace ToolKit
 
   RenderTargetPtr ShadowPass::GetShadowAtlas() { return m_shadowAtlas; }
 
-  void ShadowPass::RenderShadowMaps(Light* light)
+  void ShadowPass::CullShadowCasters()
   {
-    Renderer* renderer                                = GetRenderer();
     EngineSettings::GraphicSettings& graphicsSettings = GetEngineSettings().Graphics;
 
-    if (light->GetLightType() == Light::LightType::Directional)
+    // Collect cull frustums in the same order with the shadow map renders.
+    m_cullFrustums.clear();
+
+    // Shadow maps keep their states across frames. Maps are found by their light and index, so adding or removing a
+    // light keeps the maps of the others. Maps of the lights that are gone are dropped.
+    m_lastShadowMaps.swap(m_shadowMaps);
+    m_shadowMaps.clear();
+
+    auto addShadowMapFn = [&](Light* light, int atlasIndex, const Mat4& cullProjectView, const Mat4& projectView)
     {
-      int cascadeCount         = graphicsSettings.cascadeCount;
-      DirectionalLight* dLight = static_cast<DirectionalLight*>(light);
-      for (int i = 0; i < cascadeCount; i++)
+      m_cullFrustums.push_back(ExtractFrustum(cullProjectView, false));
+
+      ULongID lightId = light->GetIdVal();
+      auto lastItr    = std::find_if(m_lastShadowMaps.begin(),
+                                     m_lastShadowMaps.end(),
+                                     [lightId, atlasIndex](const ShadowMap& shadowMap) -> bool
+                                     { return shadowMap.lightId == lightId && shadowMap.atlasIndex == atlasIndex; });
+
+      ShadowMap& shadowMap = m_shadowMaps.emplace_back();
+      if (lastItr != m_lastShadowMaps.end())
+      {
+        shadowMap = *lastItr;
+      }
+
+      // Maps that are moved in the atlas are rendered again.
+      float layer      = (float) light->m_shadowAtlasLayers[atlasIndex];
+      float resolution = (float) light->m_shadowAtlasResolution;
+      Vec4 atlasRegion = Vec4(light->m_shadowAtlasCoords[atlasIndex], layer, resolution);
+      if (shadowMap.atlasRegion != atlasRegion)
+      {
+        shadowMap.valid = false;
+      }
+
+      shadowMap.light       = light;
+      shadowMap.lightId     = lightId;
+      shadowMap.atlasIndex  = atlasIndex;
+      shadowMap.atlasRegion = atlasRegion;
+      shadowMap.projectView = projectView;
+    };
+
+    for (Light* light : m_lights)
+    {
+      if (light->GetLightType() == Light::LightType::Directional)
+      {
+        DirectionalLight* dLight = static_cast<DirectionalLight*>(light);
+        for (int i = 0; i < graphicsSettings.cascadeCount; i++)
+        {
+          CameraPtr cullCamera = dLight->m_cascadeCullCameras[i];
+          AdjustDirectionalCullCamera(cullCamera);
+          addShadowMapFn(light,
+                         i,
+                         cullCamera->GetProjectViewMatrix(),
+                         dLight->m_cascadeShadowCameras[i]->GetProjectViewMatrix());
+        }
+      }
+      else if (light->GetLightType() == Light::LightType::Point)
+      {
+        for (int i = 0; i < 6; i++)
+        {
+          light->m_shadowCamera->m_node->SetTranslation(light->m_node->GetTranslation());
+          light->m_shadowCamera->m_node->SetOrientation(m_cubeMapRotations[i]);
+
+          Mat4 projectView = light->m_shadowCamera->GetProjectViewMatrix();
+          addShadowMapFn(light, i, projectView, projectView);
+        }
+      }
+      else
       {
-        int layer = dLight->m_shadowAtlasLayers[i];
-        m_shadowFramebuffer->SetColorAttachment(Framebuffer::Attachment::ColorAttachment0, m_shadowAtlas, 0, layer);
+        assert(light->GetLightType() == Light::LightType::Spot);
 
-        renderer->ClearBuffer(GraphicBitFields::DepthBits, m_shadowClearColor);
-        Stats::AddHWRenderPass();
+        Mat4 projectView = light->m_shadowCamera->GetProjectViewMatrix();
+        addShadowMapFn(light, 0, projectView, projectView);
+      }
+    }
+
+    m_shadowMapCasters.resize(m_cullFrustums.size());
+    assert(m_shadowMaps.size() == m_shadowMapCasters.size() && "Each shadow map must have its casters.");
+    for (EntityRawPtrArray& casters : m_shadowMapCasters)
+    {
+      casters.clear();
+    }
 
-        UVec2 coord     = dLight->m_shadowAtlasCoords[i];
-        uint resolution = (uint) light->GetShadowResVal().GetValue<float>();
-        renderer->SetViewportSize(coord.x, coord.y, resolution, resolution);
+    // Query all frustums in batches with a single traversal for each batch.
+    AABBTree& aabbTree = m_params.scene->m_aabbTree;
+    for (size_t first = 0; first < m_cullFrustums.size(); first += AABBTree::maxQueryFrustums)
+    {
+      size_t count = std::min(m_cullFrustums.size() - first, (size_t) AABBTree::maxQueryFrustums);
+      FrustumArray frustums(m_cullFrustums.begin() + first, m_cullFrustums.begin() + first + count);
 
-        RenderShadowMap(light, dLight->m_cascadeShadowCameras[i], dLight->m_cascadeCullCameras[i]);
+      // Non shadow casters are skipped in the tree.
+      aabbTree.MultiFrustumQuery(frustums, m_queryEntities, m_queryMasks, AABBTree::CategoryShadowCaster);
 
-        // Depth is invalidated because, atlas has the shadow map.
-        renderer->InvalidateFramebufferDepth(m_shadowFramebuffer);
+      for (size_t i = 0; i < m_queryEntities.size(); i++)
+      {
+        uint64 mask = m_queryMasks[i];
+        for (size_t j = 0; j < count; j++)
+        {
+          if (mask & (1ull << j))
+          {
+            m_shadowMapCasters[first + j].push_back(m_queryEntities[i]);
+          }
+        }
+      }
+    }
+  }
+
+  void ShadowPass::AdjustDirectionalCullCamera(CameraPtr cullCamera)
+  {
+    // Here we will try to find a distance that covers all shadow casters.
+    // Shadow camera placed at the outer bounds of the scene to find all shadow casters.
+    // The frustum is only used to find potential shadow casters.
+    // The tight bounds of the shadow camera which is used to create the shadow map is preserved.
+    // The casters that will fall behind the camera will still cast shadows, this is why all the fuss for.
+    // In the shader, the objects that fall behind the camera is "pancaked" to shadow camera's front plane.
+    const BoundingBox& sceneBox = m_params.scene->GetSceneBoundary();
+    Vec3 dir                    = cullCamera->Direction();
+    Vec3 pos                    = cullCamera->Position(); // Backup pos.
+    Vec3 outerPoint             = pos - glm::normalize(dir) * glm::distance(sceneBox.min, sceneBox.max) * 0.5f;
+
+    cullCamera->m_node->SetTranslation(outerPoint); // Set the camera position.
+    cullCamera->SetNearClipVal(0.0f);
+
+    // New far clip is calculated. Its the distance newly calculated outer poi
+    cullCamera->SetFarClipVal(glm::distance(outerPoint, pos) + cullCamera->Far());
+  }
+
+  void ShadowPass::RenderShadowMaps(Light* light, int& shadowMapIndex)
+  {
+    EngineSettings::GraphicSettings& graphicsSettings = GetEngineSettings().Graphics;
+
+    if (light->GetLightType() == Light::LightType::Directional)
+    {
+      int cascadeCount         = graphicsSettings.cascadeCount;
+      DirectionalLight* dLight = static_cast<DirectionalLight*>(light);
+      for (int i = 0; i < cascadeCount; i++)
+      {
+        UpdateShadowMap(light, dLight->m_cascadeShadowCameras[i], i, shadowMapIndex++);
       }
     }
     else if (light->GetLightType() == Light::LightType::Point)
     {
       for (int i = 0; i < 6; i++)
       {
-        int layer = light->m_shadowAtlasLayers[i];
-        m_shadowFramebuffer->SetColorAttachment(Framebuffer::Attachment::ColorAttachment0, m_shadowAtlas, 0, layer);
-
         light->m_shadowCamera->m_node->SetTranslation(light->m_node->GetTranslation());
         light->m_shadowCamera->m_node->SetOrientation(m_cubeMapRotations[i]);
 
-        renderer->ClearBuffer(GraphicBitFields::DepthBits, m_shadowClearColor);
-        Stats::AddHWRenderPass();
-
-        UVec2 coord     = light->m_shadowAtlasCoords[i];
-        uint resolution = (uint) light->GetShadowResVal().GetValue<float>();
-        renderer->SetViewportSize(coord.x, coord.y, resolution, resolution);
-
-        RenderShadowMap(light, light->m_shadowCamera, light->m_shadowCamera);
-
-        // Depth is invalidated because, atlas has the shadow map.
-        renderer->InvalidateFramebufferDepth(m_shadowFramebuffer);
+        UpdateShadowMap(light, light->m_shadowCamera, i, shadowMapIndex++);
       }
     }
     else
     {
       assert(light->GetLightType() == Light::LightType::Spot);
+      UpdateShadowMap(light, light->m_shadowCamera, 0, shadowMapIndex++);
+    }
+  }
 
-      m_shadowFramebuffer->SetColorAttachment(Framebuffer::Attachment::ColorAttachment0,
-                                              m_shadowAtlas,
-                                              0,
-                                              light->m_shadowAtlasLayers[0]);
+  void ShadowPass::UpdateShadowMap(Light* light, CameraPtr shadowCamera, int atlasIndex, int shadowMapIndex)
+  {
+    // Maps that don't fit in the atlas are not rendered.
+    int layer = light->m_shadowAtlasLayers[atlasIndex];
+    if (!m_shadowMaps[shadowMapIndex].update || layer == -1)
+    {
+      return;
+    }
 
-      renderer->ClearBuffer(GraphicBitFields::DepthBits, m_shadowClearColor);
-      Stats::AddHWRenderPass();
+    Renderer* renderer = GetRenderer();
+    m_shadowFramebuffer->SetColorAttachment(Framebuffer::Attachment::ColorAttachment0, m_shadowAtlas, 0, layer);
 
-      UVec2 coord     = light->m_shadowAtlasCoords[0];
-      uint resolution = (uint) light->GetShadowResVal().GetValue<float>();
+    // Other shadow maps in the layer are kept, only the region of this one is cleared.
+    UVec2 coord     = light->m_shadowAtlasCoords[atlasIndex];
+    uint resolution = (uint) light->m_shadowAtlasResolution;
+    renderer->ClearBufferRegion(GraphicBitFields::ColorDepthBits, m_shadowClearColor, coord, UVec2(resolution));
+    Stats::AddHWRenderPass();
 
-      renderer->SetViewportSize(coord.x, coord.y, resolution, resolution);
-      RenderShadowMap(light, light->m_shadowCamera, light->m_shadowCamera);
+    renderer->SetViewportSize(coord.x, coord.y, resolution, resolution);
+    RenderShadowMap(light, shadowCamera, shadowMapIndex);
+    m_updatedShadowMapCount++;
 
-      // Depth is invalidated because, atlas has the shadow map.
-      renderer->InvalidateFramebufferDepth(m_shadowFramebuffer);
-    }
+    // Depth is invalidated because, atlas has the shadow map.
+    renderer->InvalidateFramebufferDepth(m_shadowFramebuffer);
   }
 
-  void ShadowPass::RenderShadowMap(Light* light, CameraPtr shadowCamera, CameraPtr cullCamera)
+  void ShadowPass::ScheduleShadowMapUpdates()
   {
-    Renderer* renderer                                = GetRenderer();
     EngineSettings::GraphicSettings& graphicsSettings = GetEngineSettings().Graphics;
 
+    int cascadeInterval = glm::max(graphicsSettings.shadowCascadeUpdateInterval, 1);
+    int budget          = graphicsSettings.shadowMapUpdateBudget;
+    Vec3 viewPos        = m_params.viewCamera->m_node->GetTranslation(TransformationSpace::TS_WORLD);
+
+    // Collect the shadow maps whose content is changed along with their update priorities.
+    std::vector<std::pair<float, int>> candidates;
+    int requiredCount = 0;
+
+    for (int i = 0; i < (int) m_shadowMaps.size(); i++)
+    {
+      ShadowMap& shadowMap = m_shadowMaps[i];
+      shadowMap.update     = false;
+      shadowMap.casterHash = 0;
+
+      // Order independent hash of the casters. Changes when a caster enters, leaves or its render jobs are invalidated.
+      // Skeletons invalidate their jobs each frame they are posed, idle skinned casters keep the map cached.
+      for (Entity* ntt : m_shadowMapCasters[i])
+      {
+        uint64 version = 0;
+        if (MeshComponent* meshComp = ntt->GetComponentFast<MeshComponent>())
+        {
+          version = meshComp->m_renderJobVersion;
+        }
+
+        shadowMap.casterHash += MurmurHash(MurmurHash(ntt->GetIdVal()) ^ version);
+      }
+
+      // Maps that are never rendered have nothing to fall back to.
+      if (!shadowMap.valid)
+      {
+        shadowMap.update = true;
+        requiredCount++;
+        continue;
+      }
+
+      bool cameraChanged = shadowMap.renderedProjectView != shadowMap.projectView;
+      if (!cameraChanged && shadowMap.renderedCasterHash == shadowMap.casterHash)
+      {
+        continue;
+      }
+
+      // Cascades after the first one are refreshed in turns.
+      Light* light     = shadowMap.light;
+      bool directional = light->GetLightType() == Light::LightType::Directional;
+      if (directional && shadowMap.atlasIndex > 0 && (m_frameCount + shadowMap.atlasIndex) % cascadeInterval != 0)
+      {
+        m_skippedShadowMapCount++;
+        continue;
+      }
+
+      // Lights that cover a larger portion of the screen and moving cameras come first. Waiting maps gain priority.
+      float influence = 1.0f / (1.0f + shadowMap.atlasIndex);
+      if (!directional)
+      {
+        float distance = glm::distance(viewPos, light->m_node->GetTranslation(TransformationSpace::TS_WORLD));
+        influence      = glm::min(light->AffectDistance() / glm::max(distance, TK_FLT_MIN), 1.0f);
+      }
+
+      float age      = (float) (m_frameCount - shadowMap.lastUpdateFrame);
+      float priority = influence * age * (cameraChanged ? 2.0f : 1.0f);
+      candidates.push_back({priority, i});
+    }
+
+    std::sort(candidates.begin(),
+              candidates.end(),
+              [](const std::pair<float, int>& a, const std::pair<float, int>& b) -> bool { return a.first > b.first; });
+
+    int available = budget > 0 ? glm::max(budget - requiredCount, 0) : (int) candidates.size();
+    for (int i = 0; i < (int) candidates.size(); i++)
+    {
+      if (i < available)
+      {
+        m_shadowMaps[candidates[i].second].update = true;
+      }
+      else
+      {
+        m_skippedShadowMapCount++;
+      }
+    }
+
+    for (ShadowMap& shadowMap : m_shadowMaps)
+    {
+      if (shadowMap.update)
+      {
+        shadowMap.renderedProjectView = shadowMap.projectView;
+        shadowMap.renderedCasterHash  = shadowMap.casterHash;
+        shadowMap.lastUpdateFrame     = m_frameCount;
+        shadowMap.valid               = true;
+      }
+
+      // Stale maps are sampled with the camera that they are rendered with.
+      Light* light = shadowMap.light;
+      if (light->GetLightType() == Light::LightType::Directional)
+      {
+        DirectionalLight* dLight = static_cast<DirectionalLight*>(light);
+        dLight->m_shadowMapCascadeCameraProjectionViewMatrices[shadowMap.atlasIndex] = shadowMap.renderedProjectView;
+      }
+      else if (light->GetLightType() == Light::LightType::Spot)
+      {
+        if (light->m_shadowMapCameraProjectionViewMatrix != shadowMap.renderedProjectView || shadowMap.update)
+        {
+          light->m_shadowMapCameraProjectionViewMatrix = shadowMap.renderedProjectView;
+          light->m_invalidatedForLightCache            = true;
+        }
+      }
+    }
+  }
+
+  void ShadowPass::RenderShadowMap(Light* light, CameraPtr shadowCamera, int shadowMapIndex)
+  {
+    Renderer* renderer = GetRenderer();
+
     // Adjust light's camera.
     renderer->SetCamera(shadowCamera, false);
 
     Light::LightType lightType = light->GetLightType();
-    if (lightType == Light::LightType::Directional)
-    {
-      // Here we will try to find a distance that covers all shadow casters.
-      // Shadow camera placed at the outer bounds of the scene to find all shadow casters.
-      // The frustum is only used to find potential shadow casters.
-      // The tight bounds of the shadow camera which is used to create the shadow map is preserved.
-      // The casters that will fall behind the camera will still cast shadows, this is why all the fuss for.
-      // In the shader, the objects that fall behind the camera is "pancaked" to shadow camera's front plane.
-      const BoundingBox& sceneBox = m_params.scene->GetSceneBoundary();
-      Vec3 dir                    = cullCamera->Direction();
-      Vec3 pos                    = cullCamera->Position(); // Backup pos.
-      Vec3 outerPoint             = pos - glm::normalize(dir) * glm::distance(sceneBox.min, sceneBox.max) * 0.5f;
-
-      cullCamera->m_node->SetTranslation(outerPoint); // Set the camera position.
-      cullCamera->SetNearClipVal(0.0f);
-
-      // New far clip is calculated. Its the distance newly calculated outer poi
-      cullCamera->SetFarClipVal(glm::distance(outerPoint, pos) + cullCamera->Far());
-    }
-
-    // Create render jobs for shadow map generation.
-    RenderJobArray jobs;
-    RenderData renderData;
-
-    Frustum frustum            = ExtractFrustum(cullCamera->GetProjectViewMatrix(), false);
-    EntityRawPtrArray entities = m_params.scene->m_aabbTree.VolumeQuery(frustum);
-
-    // Remove non shadow casters.
-    erase_if(entities,
-             [](Entity* ntt) -> bool
-             {
-               if (MeshComponent* mc = ntt->GetComponentFast<MeshComponent>())
-               {
-                 return !mc->GetCastShadowVal();
-               }
-
-               return false;
-             });
-
-    RenderJobProcessor::CreateRenderJobs(renderData.jobs, entities);
+
+    // Create render jobs for shadow map generation. Render data is reused by all shadow maps to keep its memory.
+    RenderData& renderData = m_renderData;
+    // Casters are culled as a whole, their submeshes are culled with the same frustum.
+    RenderJobProcessor::CreateRenderJobs(renderData.jobs, m_shadowMapCasters[shadowMapIndex]);
+    RenderJobProcessor::CullRenderJobs(renderData.jobs, m_cullFrustums[shadowMapIndex]);
     RenderJobProcessor::SeperateRenderData(renderData, true);
 
     renderer->OverrideBlendState(true, BlendFunction::NONE); // Blending must be disabled for shadow map generation.
@@ -290,7 +494,7 @@ namespace ToolKit
     RenderJobItr forwardMaskedBegin = renderData.GetForwardAlphaMaskedBegin();
     for (RenderJobItr jobItr = forwardBegin; jobItr < forwardMaskedBegin; jobItr++)
     {
-      renderer->Render(*jobItr);
+      renderer->Render(renderData.jobs, *jobItr);
     }
 
     // Draw alpha masked.
@@ -301,7 +505,7 @@ namespace ToolKit
     RenderJobItr translucentBegin = renderData.GetForwardTranslucentBegin();
     for (RenderJobItr jobItr = forwardMaskedBegin; jobItr < translucentBegin; jobItr++)
     {
-      renderer->Render(*jobItr);
+      renderer->Render(renderData.jobs, *jobItr);
     }
 
     // Translucent shadow is not supported.
@@ -309,82 +513,211 @@ namespace ToolKit
     renderer->OverrideBlendState(false, BlendFunction::NONE);
   }
 
-  int ShadowPass::PlaceShadowMapsToShadowAtlas(const LightRawPtrArray& lights)
+  float ShadowPass::CalculateScreenCoverage(Light* light)
+  {
+    if (light->GetLightType() == Light::LightType::Directional)
+    {
+      return 1.0f;
+    }
+
+    // Projected size of the light's bounding sphere, relative to the screen height.
+    CameraPtr cam = m_params.viewCamera;
+    float radius  = light->AffectDistance();
+    float scale   = cam->GetProjectionMatrix()[1][1];
+    if (cam->IsOrtographic())
+    {
+      return glm::min(radius * scale, 1.0f);
+    }
+
+    Vec3 lightPos  = light->m_node->GetTranslation(TransformationSpace::TS_WORLD);
+    float distance = glm::distance(cam->m_node->GetTranslation(TransformationSpace::TS_WORLD), lightPos);
+    if (distance <= radius)
+    {
+      return 1.0f;
+    }
+
+    return glm::min(radius * scale / distance, 1.0f);
+  }
+
+  int ShadowPass::CalculateShadowResolution(Light* light, float coverage, int currentResolution)
   {
-    LightRawPtrArray lightArray = lights;
+    int resolution = (int) light->GetShadowResVal().GetValue<float>();
+    bool adaptive  = GetEngineSettings().Graphics.adaptiveShadowResolution;
+    if (light->GetLightType() == Light::LightType::Directional || !adaptive)
+    {
+      return resolution;
+    }
+
+    // Full resolution when the light covers half of the screen, halved each time the coverage is halved.
+    auto tierFn = [resolution](float desired) -> int
+    {
+      int tier = resolution;
+      while (tier / 2 >= desired && tier / 2 >= RHIConstants::MinShadowMapResolution)
+      {
+        tier /= 2;
+      }
+
+      return tier;
+    };
+
+    float desired = resolution * glm::min(coverage * 2.0f, 1.0f);
+    int tier      = tierFn(desired);
+    if (tier < currentResolution)
+    {
+      // Downscale once the coverage is well below the tier border, lights around the border don't move every frame.
+      tier = glm::min(tierFn(desired * 1.25f), currentResolution);
+    }
 
-    // Sort all lights based on resolution.
-    std::sort(lightArray.begin(),
-              lightArray.end(),
-              [](Light* l1, Light* l2) -> bool
-              { return l1->GetShadowResVal().GetValue<float>() < l2->GetShadowResVal().GetValue<float>(); });
+    return tier;
+  }
 
+  bool ShadowPass::PlaceShadowMapsToShadowAtlas(int maxLayers, bool repack)
+  {
     EngineSettings& settings = GetEngineSettings();
     const int cascadeCount   = settings.Graphics.cascadeCount;
 
-    IntArray resolutions;
-    for (size_t i = 0; i < lightArray.size(); i++)
+    auto mapCountFn          = [cascadeCount](Light* light) -> int
     {
-      Light* light   = lightArray[i];
-      int resolution = (int) light->GetShadowResVal().GetValue<float>();
+      if (light->GetLightType() == Light::LightType::Directional)
+      {
+        return cascadeCount;
+      }
 
-      if (light->GetLightType() == Light::Directional)
+      return light->GetLightType() == Light::LightType::Point ? 6 : 1;
+    };
+
+    auto resetFn = [this](bool liftLimits) -> void
+    {
+      m_packer.Reset(RHIConstants::ShadowAtlasTextureSize);
+      for (auto& [id, allocation] : m_atlasAllocations)
       {
-        for (int ii = 0; ii < cascadeCount; ii++)
+        allocation.run = BinPack2D::Run();
+        if (liftLimits)
         {
-          resolutions.push_back(resolution);
+          allocation.resolutionLimit = TK_INT_MAX;
         }
       }
-      else if (light->GetLightType() == Light::Point)
+    };
+
+    if (repack)
+    {
+      resetFn(true);
+    }
+
+    // Pick the resolutions, lights that are new or changed their tier are placed again.
+    LightRawPtrArray placedLights;
+    for (Light* light : m_lights)
+    {
+      AtlasAllocation& allocation = m_atlasAllocations[light->GetIdVal()];
+      allocation.active           = true;
+      allocation.coverage         = CalculateScreenCoverage(light);
+      if (allocation.coverage > allocation.limitCoverage * 2.0f)
       {
-        for (int ii = 0; ii < 6; ii++)
-        {
-          resolutions.push_back(resolution);
-        }
+        allocation.resolutionLimit = TK_INT_MAX;
+      }
+
+      int resolution        = CalculateShadowResolution(light, allocation.coverage, allocation.run.size);
+      allocation.resolution = glm::min(resolution, allocation.resolutionLimit);
+
+      BinPack2D::Run& run   = allocation.run;
+      if (run.layer == -1 || run.size != allocation.resolution || run.count != mapCountFn(light))
+      {
+        m_packer.Free(run);
+        placedLights.push_back(light);
+      }
+    }
+
+    // Free the maps of the lights that don't cast shadows anymore.
+    for (auto itr = m_atlasAllocations.begin(); itr != m_atlasAllocations.end();)
+    {
+      if (itr->second.active)
+      {
+        itr->second.active = false;
+        itr++;
       }
       else
       {
-        assert(light->GetLightType() == Light::LightType::Spot);
-        resolutions.push_back(resolution);
+        m_packer.Free(itr->second.run);
+        itr = m_atlasAllocations.erase(itr);
       }
     }
 
-    int layerCount                   = 0;
-    BinPack2D::PackedRectArray rects = m_packer.Pack(resolutions, RHIConstants::ShadowAtlasTextureSize, &layerCount);
+    // Larger maps are placed first to keep the layers of the same size together.
+    auto placeFn = [&]() -> bool
+    {
+      std::sort(placedLights.begin(),
+                placedLights.end(),
+                [this](Light* l1, Light* l2) -> bool
+                {
+                  int resolution1 = m_atlasAllocations[l1->GetIdVal()].resolution;
+                  int resolution2 = m_atlasAllocations[l2->GetIdVal()].resolution;
+                  return resolution1 > resolution2;
+                });
+
+      bool fits = true;
+      for (Light* light : placedLights)
+      {
+        AtlasAllocation& allocation = m_atlasAllocations[light->GetIdVal()];
+        fits &= m_packer.Allocate(allocation.resolution, mapCountFn(light), maxLayers, allocation.run);
+      }
 
-    int rectIndex                    = 0;
-    for (int i = 0; i < lightArray.size(); i++)
+      return fits;
+    };
+
+    if (!placeFn())
     {
-      Light* light = lightArray[i];
-      if (light->GetLightType() == Light::LightType::Directional)
+      // Incremental placement fragments the atlas, pack all lights from scratch.
+      repack       = true;
+      placedLights = m_lights;
+      resetFn(false);
+
+      while (!placeFn())
       {
-        for (int ii = 0; ii < cascadeCount; ii++)
+        // Downscale the light that covers the least of the screen and try again.
+        AtlasAllocation* leastCovering = nullptr;
+        for (Light* light : m_lights)
         {
-          light->m_shadowAtlasCoords[ii] = rects[rectIndex].coordinate;
-          light->m_shadowAtlasLayers[ii] = rects[rectIndex].layer;
-          rectIndex++;
+          AtlasAllocation& allocation = m_atlasAllocations[light->GetIdVal()];
+          if (allocation.resolution / 2 < RHIConstants::MinShadowMapResolution)
+          {
+            continue;
+          }
+
+          if (leastCovering == nullptr || allocation.coverage < leastCovering->coverage)
+          {
+            leastCovering = &allocation;
+          }
         }
-      }
-      else if (light->GetLightType() == Light::LightType::Point)
-      {
-        for (int ii = 0; ii < 6; ii++)
+
+        if (leastCovering == nullptr)
         {
-          light->m_shadowAtlasCoords[ii] = rects[rectIndex].coordinate;
-          light->m_shadowAtlasLayers[ii] = rects[rectIndex].layer;
-          rectIndex++;
+          GetLogger()->Log("ERROR: Shadow maps don't fit in " + std::to_string(maxLayers) + " shadow atlas layers!");
+          break;
         }
+
+        leastCovering->resolution      /= 2;
+        leastCovering->resolutionLimit  = leastCovering->resolution;
+        leastCovering->limitCoverage    = leastCovering->coverage;
+        resetFn(false);
       }
-      else
-      {
-        assert(light->GetLightType() == Light::LightType::Spot);
+    }
 
-        light->m_shadowAtlasCoords[0] = rects[rectIndex].coordinate;
-        light->m_shadowAtlasLayers[0] = rects[rectIndex].layer;
-        rectIndex++;
+    // Update the placed lights, the shader finds all the maps of a light from its first map and resolution.
+    for (Light* light : placedLights)
+    {
+      const BinPack2D::Run& run = m_atlasAllocations[light->GetIdVal()].run;
+      for (int i = 0; i < run.count; i++)
+      {
+        BinPack2D::PackedRect rect    = run.layer == -1 ? BinPack2D::PackedRect() : m_packer.GetRect(run, i);
+        light->m_shadowAtlasCoords[i] = rect.coordinate;
+        light->m_shadowAtlasLayers[i] = rect.layer;
       }
+
+      light->m_shadowAtlasResolution    = run.size;
+      light->m_invalidatedForLightCache = true;
     }
 
-    return layerCount;
+    return repack;
   }
 
   void ShadowPass::InitShadowAtlas()
@@ -410,35 +743,29 @@ namespace ToolKit
       needChange          = true;
     }
 
-    // After this loop m_previousShadowCasters is set with lights with shadows
-    int nextId = 0;
-    for (int i = 0; i < m_lights.size(); ++i)
+    // Number of layers that fit in the memory budget.
+    int maxLayers = GetRenderer()->GetMaxArrayTextureLayers();
+    if (graphicSettings.shadowAtlasBudgetMB > 0)
     {
-      Light* light = m_lights[i];
-      if (light->m_shadowResolutionUpdated)
-      {
-        light->m_shadowResolutionUpdated = false;
-        needChange                       = true;
-      }
+      uint64 texelBytes = (m_useEVSM4 ? 4 : 2) * (m_use32BitShadowMap ? 4 : 2);
+      uint64 layerBytes = (uint64) RHIConstants::ShadowAtlasTextureSize * RHIConstants::ShadowAtlasTextureSize;
+      layerBytes       *= texelBytes;
 
-      if (nextId >= m_previousShadowCasters.size())
-      {
-        needChange = true;
-        m_previousShadowCasters.push_back(light->GetIdVal());
-        nextId++;
-        continue;
-      }
-
-      if (m_previousShadowCasters[nextId] != light->GetIdVal())
-      {
-        needChange = true;
-      }
+      int budgetLayers  = (int) ((uint64) graphicSettings.shadowAtlasBudgetMB * 1024 * 1024 / layerBytes);
+      maxLayers         = glm::clamp(budgetLayers, 1, maxLayers);
+    }
 
-      m_previousShadowCasters[nextId] = light->GetIdVal();
-      nextId++;
+    if (m_maxLayerCount != maxLayers)
+    {
+      m_maxLayerCount = maxLayers;
+      needChange      = true;
     }
 
-    if (needChange && !m_lights.empty())
+    // Maps are placed every frame, their resolution follows the light's screen coverage.
+    needChange     |= PlaceShadowMapsToShadowAtlas(maxLayers, needChange);
+
+    int layerCount  = glm::max(m_packer.GetLayerCount(), 1);
+    if (needChange || layerCount > m_layerCount)
     {
       // Update materials.
       m_shadowMatOrtho->m_fragmentShader->SetDefine("EVSM4", std::to_string(m_useEVSM4));
@@ -447,18 +774,9 @@ namespace ToolKit
       m_shadowMatPersp->m_fragmentShader->SetDefine("EVSM4", std::to_string(m_useEVSM4));
       m_shadowMatPersp->m_fragmentShader->SetDefine("SMFormat16Bit", std::to_string(!m_use32BitShadowMap));
 
-      // Update layers.
-      m_previousShadowCasters.resize(nextId);
-
-      // Place shadow textures to atlas
-      m_layerCount        = PlaceShadowMapsToShadowAtlas(m_lights);
-
-      const int maxLayers = GetRenderer()->GetMaxArrayTextureLayers();
-      if (maxLayers < m_layerCount)
-      {
-        m_layerCount = maxLayers;
-        GetLogger()->Log("ERROR: Max array texture layer size is reached: " + std::to_string(maxLayers) + " !");
-      }
+      // Atlas is reconstructed, all shadow maps must be rendered again.
+      m_shadowMaps.clear();
+      m_layerCount                  = layerCount;
 
       GraphicTypes bufferComponents = m_useEVSM4 ? GraphicTypes::FormatRGBA : GraphicTypes::FormatRG;
       GraphicTypes bufferFormat     = m_useEVSM4 ? GraphicTypes::FormatRGBA32F : GraphicTypes::FormatRG32F;
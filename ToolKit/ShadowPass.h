@@ -35,18 +35,61 @@ namespace ToolKit
     RenderTargetPtr GetShadowAtlas();
 
    private:
-    /** Perform all renderings to generate all shadow maps for the given light. */
-    void RenderShadowMaps(Light* light);
+    /**
+     * Finds the shadow casters of all shadow maps with a single multi frustum query over the scene.
+     * Casters of each shadow map are stored in m_shadowMapCasters in the order that the shadow maps are rendered.
+     */
+    void CullShadowCasters();
+
+    /** Moves the directional light's cull camera to cover all the shadow casters between the scene bounds. */
+    void AdjustDirectionalCullCamera(CameraPtr cullCamera);
+
+    /**
+     * Perform all renderings to generate all shadow maps for the given light.
+     * @param shadowMapIndex Index of the light's first shadow map in m_shadowMapCasters. Advanced past its maps.
+     */
+    void RenderShadowMaps(Light* light, int& shadowMapIndex);
 
-    /** Performs a single render that generates a single shadow map of a cascade, or a face of a cube etc...*/
-    void RenderShadowMap(Light* light, CameraPtr shadowCamera, CameraPtr cullCamera);
+    /**
+     * Renders the shadow map to its region in the atlas, if its content is changed since it is last rendered.
+     * @param atlasIndex Index of the map within the light's atlas layers and coordinates.
+     * @param shadowMapIndex Index of the shadow map's casters and cull frustum.
+     */
+    void UpdateShadowMap(Light* light, CameraPtr shadowCamera, int atlasIndex, int shadowMapIndex);
+
+    /**
+     * Selects the shadow maps to render in this frame. A map needs an update if its camera or casters are changed since
+     * it is last rendered, playing skeletons change their casters each frame. Maps are prioritized by their light's
+     * screen influence, camera motion, cascade index and the frames they waited. At most
+     * GraphicSettings::shadowMapUpdateBudget maps are rendered, the rest keep their last content in the atlas and are
+     * sampled with the camera they are rendered with.
+     */
+    void ScheduleShadowMapUpdates();
 
     /**
-     * Sets layer and coordinates of the shadow maps in shadow atlas.
-     * @param lights Light array that have shadows.
-     * @return number of layers needed.
+     * Performs a single render that generates a single shadow map of a cascade, or a face of a cube etc...
+     * @param shadowMapIndex Index of the shadow map's casters and cull frustum.
      */
-    int PlaceShadowMapsToShadowAtlas(const LightRawPtrArray& lights);
+    void RenderShadowMap(Light* light, CameraPtr shadowCamera, int shadowMapIndex);
+
+    /** Returns the portion of the view camera's screen height that the light's area of effect covers. */
+    float CalculateScreenCoverage(Light* light);
+
+    /**
+     * Picks the light's shadow resolution by its screen coverage. Directional lights always use their ShadowRes.
+     * @param currentResolution is the light's resolution in the atlas. Downscaling is delayed around the tier borders.
+     */
+    int CalculateShadowResolution(Light* light, float coverage, int currentResolution);
+
+    /**
+     * Sets layer, coordinates and resolution of the shadow maps in shadow atlas. Only the lights that are new or whose
+     * resolution tier is changed are placed, the rest stay where they are. If they don't fit, all lights are repacked
+     * and the ones with the least screen coverage are downscaled until they fit.
+     * @param maxLayers is the number of layers that the atlas can grow to.
+     * @param repack discards all placements and packs the lights again.
+     * @return true if all lights are repacked.
+     */
+    bool PlaceShadowMapsToShadowAtlas(int maxLayers, bool repack);
 
     /** Creates a shadow atlas for m_params.Lights */
     void InitShadowAtlas();
@@ -65,12 +108,55 @@ namespace ToolKit
     int m_activeCascadeCount           = 0;
     bool m_useEVSM4                    = false;
     bool m_use32BitShadowMap           = true;
-    IDArray m_previousShadowCasters;
+    int m_maxLayerCount                = 0; // Layers that the atlas can grow to within the memory budget.
 
     Quaternion m_cubeMapRotations[6];
     BinPack2D m_packer;
 
+    /** Placement of a light's shadow maps in the atlas. */
+    struct AtlasAllocation
+    {
+      BinPack2D::Run run;
+      int resolution      = 0;          //!< Resolution picked for the current frame.
+      int resolutionLimit = TK_INT_MAX; //!< Downscaled resolution to fit the atlas budget.
+      float coverage      = 0.0f;       //!< Screen coverage of the light.
+      float limitCoverage = 0.0f;       //!< Coverage when the limit is set. Limit is lifted once the coverage doubles.
+      bool active         = false;      //!< The light casts shadow in the current frame.
+    };
+
+    std::unordered_map<ULongID, AtlasAllocation> m_atlasAllocations; // Shadow map placements of the lights by id.
+
     LightRawPtrArray m_lights; // Shadow casters in scene.
+
+    FrustumArray m_cullFrustums;                       // Cull frustums of all shadow maps.
+    std::vector<EntityRawPtrArray> m_shadowMapCasters; // Shadow casters of all shadow maps.
+    EntityRawPtrArray m_queryEntities;                 // Multi frustum query result, kept to reuse its memory.
+    std::vector<uint64> m_queryMasks;                  // Multi frustum query visibility masks.
+    RenderData m_renderData;                           // Render jobs of the shadow map being rendered.
+
+    /** A shadow map in the atlas, with its state in the current frame and when it is last rendered. */
+    struct ShadowMap
+    {
+      Light* light    = nullptr; //!< Valid in the current frame only.
+      ULongID lightId = 0;       //!< Light that the map is rendered for.
+      int atlasIndex  = 0;       //!< Cascade or cube face index of the map.
+      Vec4 atlasRegion;          //!< Coordinates, layer and resolution of the map in the atlas.
+
+      Mat4 projectView;          //!< Shadow camera of the current frame.
+      uint64 casterHash = 0;     //!< Casters of the current frame.
+      bool update       = false; //!< Rendered in the current frame.
+
+      Mat4 renderedProjectView;          //!< Shadow camera that the map in the atlas is rendered with.
+      uint64 renderedCasterHash = 0;     //!< Casters that the map in the atlas is rendered with.
+      uint64 lastUpdateFrame    = 0;     //!< Frame that the map is last rendered in.
+      bool valid                = false; //!< The map is rendered at least once.
+    };
+
+    std::vector<ShadowMap> m_shadowMaps;     // Shadow maps of the current lights in render order.
+    std::vector<ShadowMap> m_lastShadowMaps; // Shadow maps of the previous frame, kept to reuse its memory.
+    int m_updatedShadowMapCount = 0;         // Shadow maps rendered in the current frame.
+    int m_skippedShadowMapCount = 0;         // Maps that needed an update, but are postponed in the current frame.
+    uint64 m_frameCount         = 0;
   };
 
   typedef std::shared_ptr<ShadowPass> ShadowPassPtr;
@@ -8,6 +8,7 @@
 #include "Skeleton.h"
 
 #include "FileManager.h"
+#include "FrameArena.h"
 #include "MathUtil.h"
 #include "Node.h"
 #include "RHI.h"
@@ -24,12 +25,21 @@ namespace ToolKit
 
   StaticBone::~StaticBone() {}
 
-  // Create a texture such that there is mat4x4 per bone
+  void PackBoneTransform(const Mat4& transform, Vec4* texels)
+  {
+    Mat4 rows = glm::transpose(transform);
+    texels[0] = rows[0];
+    texels[1] = rows[1];
+    texels[2] = rows[2];
+    texels[3] = Vec4(0.0f);
+  }
+
+  // Create a texture such that there is an affine mat3x4 and a translation error texel per bone
   TexturePtr CreateBoneTransformTexture(const Skeleton* skeleton)
   {
     TexturePtr ptr = MakeNewPtr<Texture>();
     ptr->m_height  = 1;
-    ptr->m_width   = (int) (skeleton->m_bones.size()) * 4;
+    ptr->m_width   = (int) (skeleton->m_bones.size()) * BoneTransformTexelCount;
     TextureSettings set;
     set.GenerateMipMap = false;
     set.InternalFormat = GraphicTypes::FormatRGBA32F;
@@ -53,11 +63,20 @@ namespace ToolKit
     return ptr;
   }
 
-  void uploadBoneMatrix(Mat4 mat, TexturePtr& ptr, uint boneIndx)
+  void UploadBoneTransforms(const Mat4Array& boneTransforms, const TexturePtr& texture)
   {
-    RHI::SetTexture(GL_TEXTURE_2D, ptr->m_textureId);
-    glTexSubImage2D(GL_TEXTURE_2D, 0, boneIndx * 4, 0, 4, 1, GL_RGBA, GL_FLOAT, &mat);
-  };
+    size_t texelCount = boneTransforms.size() * BoneTransformTexelCount;
+    assert(texelCount <= (size_t) texture->m_width && "Bone count exceeds the texture.");
+
+    FrameArray<Vec4> texels(texelCount, FrameArena::Get());
+    for (size_t i = 0; i < boneTransforms.size(); i++)
+    {
+      PackBoneTransform(boneTransforms[i], texels.data() + i * BoneTransformTexelCount);
+    }
+
+    RHI::SetTexture(GL_TEXTURE_2D, texture->m_textureId);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, (GLsizei) texelCount, 1, GL_RGBA, GL_FLOAT, texels.data());
+  }
 
   // DynamicBoneMap
   //////////////////////////////////////////
@@ -112,6 +131,23 @@ namespace ToolKit
     }
   }
 
+  void DynamicBoneMap::ResetToBindPose(const Skeleton* skeleton)
+  {
+    for (const auto& [name, tPoseBone] : skeleton->m_Tpose.m_boneMap)
+    {
+      auto dBoneItr = m_boneMap.find(name);
+      if (dBoneItr == m_boneMap.end())
+      {
+        continue;
+      }
+
+      Node* tPoseNode = tPoseBone.node;
+      dBoneItr->second.node->SetLocalTransforms(tPoseNode->GetTranslation(TransformationSpace::TS_LOCAL),
+                                                tPoseNode->GetOrientation(TransformationSpace::TS_LOCAL),
+                                                tPoseNode->GetScale());
+    }
+  }
+
   DynamicBoneMap::DynamicBoneMap() {}
 
   DynamicBoneMap::~DynamicBoneMap()
@@ -169,7 +205,20 @@ namespace ToolKit
 
   Skeleton::~Skeleton() { UnInit(); }
 
-  void Skeleton::Init(bool flushClientSideArray) {}
+  void Skeleton::Init(bool flushClientSideArray)
+  {
+    // Bones are created on load, which may run on a worker thread. The texture is created on the main thread.
+    if (m_bindPoseTexture != nullptr || m_bones.empty())
+    {
+      return;
+    }
+
+    m_bindPoseTexture = CreateBoneTransformTexture(this);
+
+    Mat4Array bindPose;
+    CalculateSkinningPalette(this, nullptr, false, bindPose);
+    UploadBoneTransforms(bindPose, m_bindPoseTexture);
+  }
 
   void Skeleton::UnInit()
   {
@@ -336,13 +385,7 @@ namespace ToolKit
       Traverse(node, nullptr, this);
     }
 
-    m_bindPoseTexture = CreateBoneTransformTexture(this);
-    for (uint boneIndx = 0; boneIndx < m_bones.size(); boneIndx++)
-    {
-      Mat4 transform = m_Tpose.m_boneMap[m_bones[boneIndx]->m_name].node->GetTransform();
-      uploadBoneMatrix(transform * m_bones[boneIndx]->m_inverseWorldMatrix, m_bindPoseTexture, (uint) boneIndx);
-    }
-
+    // Bind pose texture is created by Init.
     m_initiated = true;
 
     return nullptr;
@@ -43,6 +43,9 @@ namespace ToolKit
 
     void Init(const Skeleton* skeleton);
 
+    /** Sets the local transforms of all bones to the bind pose of the skeleton that the map is created from. */
+    void ResetToBindPose(const Skeleton* skeleton);
+
     void ForEachRootBone(std::function<void(const DynamicBone*)> childProcessFunc) const;
     void AddDynamicBone(const String& boneName, DynamicBone& bone, DynamicBone* parent);
 
@@ -77,6 +80,25 @@ namespace ToolKit
     TexturePtr m_bindPoseTexture = nullptr;
   };
 
+  /**
+   * Number of texels that a bone matrix takes in the bone transform and animation data textures. Only the rows of
+   * the affine part are stored, skinning.shader restores the last row. The last texel holds the rounding error of the
+   * translation for half precision textures, skinning.shader adds it back to the translation.
+   */
+  static constexpr int BoneTransformTexelCount = 4;
+
+  /**
+   * Writes the rows of the affine part of the bone matrix to BoneTransformTexelCount texels. Translation error texel
+   * is left zero, full precision textures don't need it.
+   */
+  TK_API void PackBoneTransform(const Mat4& transform, Vec4* texels);
+
+  /** Creates a texture that holds a matrix per bone in a row, in the layout that skinning.shader samples. */
+  TK_API TexturePtr CreateBoneTransformTexture(const Skeleton* skeleton);
+
+  /** Uploads the bone matrices to the texture created by CreateBoneTransformTexture with a single update. */
+  TK_API void UploadBoneTransforms(const Mat4Array& boneTransforms, const TexturePtr& texture);
+
   class TK_API SkeletonManager : public ResourceManager
   {
    public:
@@ -7,6 +7,9 @@
 
 #include "SkeletonComponent.h"
 
+#include "MathUtil.h"
+#include "Skeleton.h"
+#include "Texture.h"
 #include "ToolKit.h"
 
 
@@ -45,6 +48,41 @@ namespace ToolKit
 
   const AnimData& SkeletonComponent::GetAnimData() const { return m_animData; }
 
+  void SkeletonComponent::UpdateBonePalette()
+  {
+    const SkeletonPtr& resource = GetSkeletonResourceVal();
+    if (resource == nullptr || m_map == nullptr)
+    {
+      return;
+    }
+
+    CalculateSkinningPalette(resource.get(), m_map, true, m_bonePalette);
+  }
+
+  void SkeletonComponent::UploadBonePalette()
+  {
+    const SkeletonPtr& resource = GetSkeletonResourceVal();
+    if (resource == nullptr || m_bonePalette.empty())
+    {
+      return;
+    }
+
+    TexturePtr& palette = m_animData.bonePalette;
+    if (palette == nullptr || palette->m_width != (int) m_bonePalette.size() * BoneTransformTexelCount)
+    {
+      palette         = CreateBoneTransformTexture(resource.get());
+      palette->m_name = resource->m_name + " BonePalette";
+    }
+
+    UploadBoneTransforms(m_bonePalette, palette);
+  }
+
+  void SkeletonComponent::ReleaseBonePalette()
+  {
+    m_animData.bonePalette = nullptr;
+    m_bonePalette.clear();
+  }
+
   void SkeletonComponent::ParameterConstructor()
   {
     Super::ParameterConstructor();
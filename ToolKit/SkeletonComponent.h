@@ -26,6 +26,10 @@ namespace ToolKit
     float blendSecondKeyFrame            = 0.0f; // normalized via (firstKeyFrame / keyFrameCount)
     float blendKeyFrameInterpolationTime = 0.0f;
     float blendKeyFrameCount             = 1.0f; // default value is 1 to prevent division with 0
+
+    float currentTime                    = 0.0f; // time of the current animation in seconds
+    float blendTime                      = 0.0f; // time of the blend animation in seconds
+    TexturePtr bonePalette               = nullptr; // pose evaluated on the cpu, used instead of the baked textures
   };
 
   static VariantCategory SkeletonComponentCategory {"Skeleton Component", 90};
@@ -53,6 +57,18 @@ namespace ToolKit
 
     const AnimData& GetAnimData() const;
 
+    /**
+     * Calculates the skinning matrices of the bones from their current pose. Bones must be posed on the cpu.
+     * Only touches this component's data, components can be updated in parallel.
+     */
+    void UpdateBonePalette();
+
+    /** Uploads the bone palette to the palette texture with a single update. Creates the texture if needed. */
+    void UploadBonePalette();
+
+    /** Releases the bone palette, the baked animation textures are sampled instead. */
+    void ReleaseBonePalette();
+
    protected:
     void ParameterConstructor() override;
     XmlNode* DeSerializeImp(const SerializationFileInfo& info, XmlNode* parent) override;
@@ -66,6 +82,7 @@ namespace ToolKit
 
    private:
     AnimData m_animData;
+    Mat4Array m_bonePalette;
   };
 
 } // namespace ToolKit
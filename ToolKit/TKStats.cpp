@@ -94,6 +94,54 @@ namespace ToolKit
       }
     }
 
+    uint64 GetFrameArenaBytes()
+    {
+      if (TKStats* tkStats = GetTKStats())
+      {
+        return tkStats->m_frameArenaBytes;
+      }
+      else
+      {
+        return 0;
+      }
+    }
+
+    uint64 GetFrameArenaSavedAllocations()
+    {
+      if (TKStats* tkStats = GetTKStats())
+      {
+        return tkStats->m_frameArenaSavedAllocations;
+      }
+      else
+      {
+        return 0;
+      }
+    }
+
+    uint64 GetShadowMapUpdatesPerFrame()
+    {
+      if (TKStats* tkStats = GetTKStats())
+      {
+        return tkStats->m_shadowMapUpdatesPerFrame;
+      }
+      else
+      {
+        return 0;
+      }
+    }
+
+    uint64 GetShadowMapSkipsPerFrame()
+    {
+      if (TKStats* tkStats = GetTKStats())
+      {
+        return tkStats->m_shadowMapSkipsPerFrame;
+      }
+      else
+      {
+        return 0;
+      }
+    }
+
     uint64 GetTotalVRAMUsageInBytes()
     {
       if (TKStats* tkStats = GetTKStats())
@@ -206,6 +254,15 @@ namespace ToolKit
       }
     }
 
+    void ResetShadowMapUpdatesPerFrame()
+    {
+      if (TKStats* tkStats = GetTKStats())
+      {
+        tkStats->m_shadowMapUpdatesPerFrame = 0;
+        tkStats->m_shadowMapSkipsPerFrame   = 0;
+      }
+    }
+
     void ResetHWRenderPassCounter()
     {
       if (TKStats* tkStats = GetTKStats())
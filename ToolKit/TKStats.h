@@ -84,6 +84,14 @@ namespace ToolKit
     float m_elapsedCpuRenderTimeAvg       = 0.0f;
     /** Number of times the light cache invalidated for a frame */
     uint m_lightCacheInvalidationPerFrame = 0;
+    /** Bytes allocated from the frame arenas in the last frame. */
+    uint64 m_frameArenaBytes              = 0;
+    /** Heap allocations that the frame arenas served instead of the heap in the last frame. */
+    uint64 m_frameArenaSavedAllocations   = 0;
+    /** Number of shadow maps rendered in a frame. */
+    uint m_shadowMapUpdatesPerFrame       = 0;
+    /** Number of shadow maps that needed an update, but are postponed by the shadow update budget in a frame. */
+    uint m_shadowMapSkipsPerFrame         = 0;
     /** Timers added to the source. */
     std::unordered_map<String, TimeArgs> m_profileTimerMap;
 
@@ -101,6 +109,10 @@ namespace ToolKit
     TK_API void BeginTimeScope(StringView name);
     TK_API void EndTimeScope(StringView name);
     TK_API uint64 GetLightCacheInvalidationPerFrame();
+    TK_API uint64 GetFrameArenaBytes();
+    TK_API uint64 GetFrameArenaSavedAllocations();
+    TK_API uint64 GetShadowMapUpdatesPerFrame();
+    TK_API uint64 GetShadowMapSkipsPerFrame();
     TK_API uint64 GetTotalVRAMUsageInBytes();
     TK_API uint64 GetTotalVRAMUsageInKB();
     TK_API uint64 GetTotalVRAMUsageInMB();
@@ -113,6 +125,7 @@ namespace ToolKit
     TK_API void AddHWRenderPass();
     TK_API void RemoveHWRenderPass();
     TK_API void ResetLightCacheInvalidationPerFrame();
+    TK_API void ResetShadowMapUpdatesPerFrame();
     TK_API void ResetHWRenderPassCounter();
     TK_API uint64 GetHWRenderPassCount();
     TK_API void GetRenderTime(float& cpu, float& gpu);
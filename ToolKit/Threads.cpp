@@ -13,6 +13,9 @@
 namespace ToolKit
 {
 
+  /** Set for the threads that are running a task within a ParallelTaskScope. */
+  static thread_local bool g_inParallelTask = false;
+
   WorkerManager::WorkerManager() {}
 
   WorkerManager::~WorkerManager() { UnInit(); }
@@ -60,6 +63,8 @@ namespace ToolKit
     ExecuteTasks(m_mainThreadTasks, m_mainTaskMutex);
   }
 
+  bool WorkerManager::InParallelTask() { return g_inParallelTask; }
+
   void WorkerManager::ExecuteTasks(TaskQueue& queue, std::mutex& mex)
   {
     for (int i = 0; i < (int) queue.size(); i++)
@@ -73,4 +78,12 @@ namespace ToolKit
     }
   }
 
+  ParallelTaskScope::ParallelTaskScope()
+  {
+    m_outerScope     = g_inParallelTask;
+    g_inParallelTask = true;
+  }
+
+  ParallelTaskScope::~ParallelTaskScope() { g_inParallelTask = m_outerScope; }
+
 } // namespace ToolKit
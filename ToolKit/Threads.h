@@ -56,6 +56,12 @@ namespace ToolKit
     /** Stops waiting tasks and completes ongoing tasks on all pools and threads. */
     void Flush();
 
+    /**
+     * Returns true if the calling thread is running a task within a ParallelTaskScope. Parallel loops issued from such
+     * threads run sequentially, because waiting for nested tasks on a pool worker may block all the workers.
+     */
+    static bool InParallelTask();
+
     template <typename F, typename... A, typename R = std::invoke_result_t<std::decay_t<F>, std::decay_t<A>...>>
     std::future<R> AsyncTask(Executor exec, F&& func, A&&... args)
     {
@@ -92,15 +98,32 @@ namespace ToolKit
     std::mutex m_mainTaskMutex;
   };
 
+  /**
+   * Marks the calling thread as running a parallel task for the lifetime of the scope.
+   * Tasks that may issue parallel loops, such as resource loading, must be wrapped with it.
+   */
+  class TK_API ParallelTaskScope
+  {
+   public:
+    ParallelTaskScope();
+    ~ParallelTaskScope();
+
+   private:
+    bool m_outerScope; //!< State of the thread before the scope is entered, allows nested scopes.
+  };
+
 /**
  * Parallel loop execution target which lets the programmer to choose the thread pool to execute for loop on.
  * Allows to decide to run for loop sequential or parallel based on the given condition.
  */
 #define TKExecByConditional(Condition, Target)                                                                         \
-  poolstl::par_if((Condition) && Main::GetInstance()->m_threaded, GetWorkerManager()->GetPool(Target))
+  poolstl::par_if((Condition) && Main::GetInstance()->m_threaded && !WorkerManager::InParallelTask(),                  \
+                  GetWorkerManager()->GetPool(Target))
 
 /** Parallel loop execution target which lets the programmer to choose the thread pool to execute for loop on. */
-#define TKExecBy(Target)         poolstl::par_if(Main::GetInstance()->m_threaded, GetWorkerManager()->GetPool(Target))
+#define TKExecBy(Target)                                                                                               \
+  poolstl::par_if(Main::GetInstance()->m_threaded && !WorkerManager::InParallelTask(),                                 \
+                  GetWorkerManager()->GetPool(Target))
 
 /** Insert an async task to given target. */
 #define TKAsyncTask(Target, ...) GetWorkerManager()->AsyncTask(Target, __VA_ARGS__);
@@ -10,6 +10,7 @@
 #include "Audio.h"
 #include "EngineSettings.h"
 #include "FileManager.h"
+#include "FrameArena.h"
 #include "GpuProgram.h"
 #include "Logger.h"
 #include "Material.h"
@@ -30,36 +31,60 @@ namespace ToolKit
 {
   HandleManager::HandleManager()
   {
-    ULongID seed = time(nullptr) + ((ULongID) (this) ^ m_randomXor[0]);
-    Xoroshiro128PlusSeed(m_randomXor, seed);
+    m_seed        = time(nullptr) + (ULongID) (this);
+    m_streamCount = 0;
   }
 
   ULongID HandleManager::GenerateHandle()
   {
-    ULongID id = Xoroshiro128Plus(m_randomXor);
+    // Each thread has its own random state, no synchronization needed for generating the ids.
+    thread_local ULongID randomXor[2]       = {0, 0};
+    thread_local HandleManager* streamOwner = nullptr;
+
+    if (streamOwner != this)
+    {
+      // Golden ratio increment separates the seeds of the streams.
+      ULongID stream = m_streamCount.fetch_add(1, std::memory_order_relaxed);
+      Xoroshiro128PlusSeed(randomXor, m_seed + stream * 0x9E3779B97F4A7C15ULL);
+      streamOwner = this;
+    }
+
+    ULongID id = Xoroshiro128Plus(randomXor);
     // If collision happens, change generate new id
-    while (m_uniqueIDs.find(id) != m_uniqueIDs.end() || id == NULL_HANDLE)
+    while (id == NULL_HANDLE || !AddHandle(id))
     {
-      id = Xoroshiro128Plus(m_randomXor);
+      id = Xoroshiro128Plus(randomXor);
     }
-    m_uniqueIDs.insert(id);
 
     return id; // non zero
   }
 
-  void HandleManager::AddHandle(ULongID val) { m_uniqueIDs.insert(val); }
+  bool HandleManager::AddHandle(ULongID val)
+  {
+    HandleShard& shard = GetShard(val);
+    std::lock_guard<std::mutex> guard(shard.lock);
+    return shard.uniqueIDs.insert(val).second;
+  }
 
   void HandleManager::ReleaseHandle(ULongID val)
   {
+    HandleShard& shard = GetShard(val);
+    std::lock_guard<std::mutex> guard(shard.lock);
+    shard.uniqueIDs.erase(val);
+  }
 
-    auto it = m_uniqueIDs.find(val);
-    if (it != m_uniqueIDs.end())
-    {
-      m_uniqueIDs.erase(it);
-    }
+  bool HandleManager::IsHandleUnique(ULongID val)
+  {
+    HandleShard& shard = GetShard(val);
+    std::lock_guard<std::mutex> guard(shard.lock);
+    return shard.uniqueIDs.find(val) == shard.uniqueIDs.end();
   }
 
-  bool HandleManager::IsHandleUnique(ULongID val) { return m_uniqueIDs.find(val) == m_uniqueIDs.end(); }
+  HandleManager::HandleShard& HandleManager::GetShard(ULongID val)
+  {
+    // Ids are random, mixing high and low bits is sufficient for even distribution.
+    return m_shards[(val ^ (val >> 32)) & (ShardCount - 1)];
+  }
 
   Main* Main::m_proxy = nullptr;
 
@@ -238,6 +263,7 @@ namespace ToolKit
     Stats::ResetDrawCallCounter();
     Stats::ResetHWRenderPassCounter();
     Stats::ResetLightCacheInvalidationPerFrame();
+    Stats::ResetShadowMapUpdatesPerFrame();
   }
 
   void Main::FrameUpdate()
@@ -272,6 +298,7 @@ namespace ToolKit
 
     m_timing.LastTime = m_timing.CurrentTime;
     GetRenderSystem()->EndFrame();
+    FrameArena::EndFrame();
 
     // Display stat times.
     for (auto& timeStat : TKStatTimerMap)
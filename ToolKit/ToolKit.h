@@ -39,16 +39,35 @@ namespace ToolKit
     /**
      * Random id that guarantees uniqueness on runtime. Collisions are resolved during deserialize, if any.
      * These ids, freed when using of it completed. So ids are reused and do not overflow.
+     * Thread safe. Each thread generates ids from its own random stream.
      */
     ULongID GenerateHandle();
 
-    void AddHandle(ULongID val);     //!< Add record for the random id. Prevent it from getting acquired multiple times.
-    void ReleaseHandle(ULongID val); //!< Free the id for reuse.
+    /**
+     * Add record for the random id. Prevent it from getting acquired multiple times.
+     * @return False if the id is already acquired, so the check and the record happens atomically.
+     */
+    bool AddHandle(ULongID val);
+    void ReleaseHandle(ULongID val);  //!< Free the id for reuse.
     bool IsHandleUnique(ULongID val); //!< Test if id acquired.
 
    private:
-    ULongID m_randomXor[2];                  //!< Random seed.
-    std::unordered_set<ULongID> m_uniqueIDs; //!< Container for all acquired handles.
+    /** A partition of the acquired handles with its own lock. Allows concurrent access to different shards. */
+    struct HandleShard
+    {
+      std::mutex lock;                       //!< Guards the shard.
+      std::unordered_set<ULongID> uniqueIDs; //!< Acquired handles that fall into this shard.
+    };
+
+    /** Returns the shard that the given handle belongs to. */
+    HandleShard& GetShard(ULongID val);
+
+   private:
+    static const int ShardCount = 16;   //!< Number of shards. Must be a power of two.
+
+    ULongID m_seed;                     //!< Random seed. Random streams of the threads are derived from it.
+    std::atomic<ULongID> m_streamCount; //!< Number of random streams created so far.
+    HandleShard m_shards[ShardCount];   //!< Container for all acquired handles.
   };
 
   /**
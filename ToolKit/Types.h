@@ -33,16 +33,19 @@
 
 // STL
 #include <array>
+#include <atomic>
 #include <deque>
 #include <filesystem>
 #include <functional>
 #include <future>
 #include <limits>
 #include <memory>
+#include <mutex>
 #include <queue>
 #include <random>
 #include <set>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -120,7 +123,6 @@ namespace ToolKit
   typedef std::vector<uint> UIntArray;
   typedef std::vector<bool> BoolArray;
   typedef std::vector<struct VariantCategory> VariantCategoryArray;
-  typedef std::vector<struct RenderJob> RenderJobArray;
   typedef void* SoundBuffer; //!< Internal sound buffer object used for decoding / loading audio.
   typedef void* ZipFile;
 
@@ -360,6 +362,7 @@ namespace ToolKit
     ColorAttachment0           = 0x8CE0,
     DepthAttachment            = 0x8D00,
     TypeFloat                  = 0x1406,
+    TypeHalfFloat              = 0x140B,
     TypeUnsignedByte           = 0x1401,
     Target2D                   = 0x0DE1,
     TargetCubeMap              = 0x8513,